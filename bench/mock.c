@@ -0,0 +1,734 @@
+/*
+ * mock — a fake desktop for `make bench`
+ *
+ * serves synthetic accessibility trees on the bus in AT_SPI_BUS_ADDRESS
+ * (a private one, see run.sh): one forked process per app, so each has
+ * its own pid and bus name, plus a registry answering for the desktop.
+ * the registry also serves canned j/clients, j/monitors, j/activewindow
+ * and j/cursorpos on a fake hyprland .socket.sock. prints "ready" once
+ * everything is up and runs until killed.
+ *
+ * every app has one window. its tree is a complete k-ary tree numbered
+ * breadth first, so the children of node i are i*k+1 .. i*k+k and
+ * nothing is stored per node. inner nodes are panels covering the
+ * window, leaves are laid out in a grid over --pages window heights
+ * (more than 1 puts most of them offscreen). gtk4 apps report every
+ * position as (0,0), chromium apps report them window-relative.
+ *
+ * build:
+ *   make bench/mock
+ * or manually:
+ *   gcc -O2 -o bench/mock bench/mock.c $(pkg-config --cflags --libs gio-2.0)
+ */
+
+#include <gio/gio.h>
+#include <glib-unix.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* AtspiRole and AtspiStateType values, as they go over the wire */
+enum {
+    ROLE_CHECK_BOX = 7, ROLE_DESKTOP_FRAME = 14, ROLE_FILLER = 20,
+    ROLE_FRAME = 23, ROLE_IMAGE = 27, ROLE_LABEL = 29, ROLE_LIST_ITEM = 32,
+    ROLE_MENU_ITEM = 35, ROLE_PAGE_TAB = 37, ROLE_PANEL = 39,
+    ROLE_PUSH_BUTTON = 43, ROLE_SEPARATOR = 50, ROLE_TABLE_CELL = 56,
+    ROLE_TOGGLE_BUTTON = 62, ROLE_APPLICATION = 75, ROLE_ENTRY = 79,
+    ROLE_SECTION = 85, ROLE_LINK = 88,
+};
+enum {
+    STATE_ACTIVE = 1, STATE_ENABLED = 8, STATE_FOCUSABLE = 11,
+    STATE_SENSITIVE = 24, STATE_SHOWING = 25, STATE_VISIBLE = 30,
+};
+#define BIT(s) (1u << (s))
+
+enum { KIND_NORMAL, KIND_GTK4, KIND_CHROMIUM };
+
+#define SCREEN_W  2560
+#define SCREEN_H  1440
+#define BAR_H     30   /* windows start below a bar, never at (0,0) */
+#define GAP       10
+
+static struct {
+    int nodes;      /* over all apps */
+    int apps;
+    int fanout;
+    int depth;      /* if set, the fan-out follows from it */
+    int gtk4;       /* the last this many apps have broken coords */
+    int chromium;   /* the ones before them are window-relative */
+    int clickable;  /* percent of leaves with a clickable role */
+    int pages;      /* window heights the leaves are spread over */
+    const char *hypr;
+} opt = {
+    .nodes = 1000, .apps = 4, .fanout = 8, .clickable = 70, .pages = 1,
+};
+
+/* leaves cycle through these; the names are what search finds */
+static const struct { guint32 role; const char *name; } leaf_kinds[] = {
+    { ROLE_PUSH_BUTTON, "button" }, { ROLE_LINK, "link" },
+    { ROLE_LINK, "article" }, { ROLE_CHECK_BOX, "check" },
+    { ROLE_MENU_ITEM, "menu item" }, { ROLE_PAGE_TAB, "tab" },
+    { ROLE_LIST_ITEM, "row" }, { ROLE_TABLE_CELL, "cell" },
+    { ROLE_ENTRY, "search" }, { ROLE_TOGGLE_BUTTON, "toggle" },
+};
+static const guint32 plain_roles[] = { ROLE_LABEL, ROLE_IMAGE, ROLE_SEPARATOR };
+static const guint32 box_roles[] = { ROLE_PANEL, ROLE_FILLER, ROLE_SECTION };
+
+/* this process's app */
+static struct {
+    int index, kind;
+    int n;              /* nodes in the tree */
+    int inner;          /* nodes 0 .. inner-1 have children */
+    int x, y, w, h;
+    int cols, cell_w, cell_h;
+    const char *bus;    /* our unique name */
+} me;
+
+static const char *const root_path = "/org/a11y/atspi/accessible/root";
+
+/* ------------------------------------------------------------------ */
+/*  layout                                                             */
+/* ------------------------------------------------------------------ */
+
+/* app 0 is the focused one and always normal */
+static int app_kind(int i) {
+    if (i == 0) return KIND_NORMAL;
+    if (i >= opt.apps - opt.gtk4) return KIND_GTK4;
+    if (i >= opt.apps - opt.gtk4 - opt.chromium) return KIND_CHROMIUM;
+    return KIND_NORMAL;
+}
+
+/* windows tile the screen below the bar */
+static void app_geom(int i, int *x, int *y, int *w, int *h) {
+    int cols = (int)ceil(sqrt(opt.apps));
+    int rows = (opt.apps + cols - 1) / cols;
+    int cw = (SCREEN_W - GAP) / cols, ch = (SCREEN_H - BAR_H - GAP) / rows;
+    *x = GAP + (i % cols) * cw;
+    *y = BAR_H + GAP + (i / cols) * ch;
+    *w = cw - GAP;
+    *h = ch - GAP;
+}
+
+static void app_title(int i, char *buf, size_t sz) {
+    static const char *const kinds[] = { "normal", "gtk4", "chromium" };
+    snprintf(buf, sz, "mock %d (%s)", i, kinds[app_kind(i)]);
+}
+
+static guint32 node_hash(int i) {
+    guint32 h = (guint32)i * 2654435761u;
+    return h ^ (h >> 15);
+}
+
+static int node_children(int i) {
+    int first = i * opt.fanout + 1;
+    return CLAMP(me.n - first, 0, opt.fanout);
+}
+
+static gboolean node_clickable(int i) {
+    return i >= me.inner && (int)(node_hash(i) % 100) < opt.clickable;
+}
+
+static guint32 node_role(int i) {
+    if (i == 0) return ROLE_FRAME;
+    if (i < me.inner) return box_roles[i % G_N_ELEMENTS(box_roles)];
+    guint32 h = node_hash(i) >> 8;
+    if (node_clickable(i)) return leaf_kinds[h % G_N_ELEMENTS(leaf_kinds)].role;
+    return plain_roles[h % G_N_ELEMENTS(plain_roles)];
+}
+
+static void node_name(int i, char *buf, size_t sz) {
+    if (i == 0) app_title(me.index, buf, sz);
+    else if (node_clickable(i))
+        snprintf(buf, sz, "%s %d",
+                 leaf_kinds[(node_hash(i) >> 8) % G_N_ELEMENTS(leaf_kinds)].name, i);
+    else buf[0] = '\0';
+}
+
+static void node_path(int i, char *buf, size_t sz) {
+    if (i < 0) snprintf(buf, sz, "%s", root_path);
+    else snprintf(buf, sz, "/org/a11y/atspi/accessible/%d", i);
+}
+
+static void node_states(int i, guint32 st[2]) {
+    st[0] = BIT(STATE_VISIBLE) | BIT(STATE_SHOWING) | BIT(STATE_ENABLED) |
+            BIT(STATE_SENSITIVE);
+    if (node_clickable(i)) st[0] |= BIT(STATE_FOCUSABLE);
+    if (i == 0 && me.index == 0) st[0] |= BIT(STATE_ACTIVE);
+    st[1] = 0;
+}
+
+static void node_extents(int i, int r[4]) {
+    if (i < me.inner) {
+        r[0] = 0; r[1] = 0; r[2] = me.w; r[3] = me.h;
+    } else {
+        int k = i - me.inner;
+        r[0] = (k % me.cols) * me.cell_w;
+        r[1] = (k / me.cols) * me.cell_h;
+        r[2] = MAX(me.cell_w - 2, 1);
+        r[3] = MAX(me.cell_h - 2, 1);
+    }
+    if (me.kind == KIND_GTK4) {
+        r[0] = r[1] = 0;
+    } else if (me.kind == KIND_NORMAL) {
+        r[0] += me.x;
+        r[1] += me.y;
+    }
+}
+
+static void app_layout(int i) {
+    me.index = i;
+    me.kind = app_kind(i);
+    me.n = MAX(opt.nodes / opt.apps, 2);
+    me.inner = (me.n - 2) / opt.fanout + 1;
+    app_geom(i, &me.x, &me.y, &me.w, &me.h);
+
+    /* as square cells as fit the leaves into the pages */
+    int leaves = me.n - me.inner;
+    double page_h = (double)me.h * opt.pages;
+    me.cols = MAX((int)ceil(sqrt(leaves * me.w / page_h)), 1);
+    int rows = (leaves + me.cols - 1) / me.cols;
+    me.cell_w = MAX(me.w / me.cols, 2);
+    me.cell_h = MAX((int)(page_h / rows), 2);
+}
+
+/* ------------------------------------------------------------------ */
+/*  d-bus                                                              */
+/* ------------------------------------------------------------------ */
+
+static const char introspection_xml[] =
+    "<node>"
+    " <interface name='org.a11y.atspi.Accessible'>"
+    "  <method name='GetChildAtIndex'><arg direction='in' type='i'/><arg direction='out' type='(so)'/></method>"
+    "  <method name='GetChildren'><arg direction='out' type='a(so)'/></method>"
+    "  <method name='GetIndexInParent'><arg direction='out' type='i'/></method>"
+    "  <method name='GetRole'><arg direction='out' type='u'/></method>"
+    "  <method name='GetState'><arg direction='out' type='au'/></method>"
+    "  <method name='GetInterfaces'><arg direction='out' type='as'/></method>"
+    "  <method name='GetApplication'><arg direction='out' type='(so)'/></method>"
+    "  <property name='Name' type='s' access='read'/>"
+    "  <property name='Description' type='s' access='read'/>"
+    "  <property name='Parent' type='(so)' access='read'/>"
+    "  <property name='ChildCount' type='i' access='read'/>"
+    "  <property name='Locale' type='s' access='read'/>"
+    " </interface>"
+    " <interface name='org.a11y.atspi.Component'>"
+    "  <method name='GetExtents'><arg direction='in' type='u'/><arg direction='out' type='(iiii)'/></method>"
+    " </interface>"
+    " <interface name='org.a11y.atspi.Application'>"
+    "  <property name='ToolkitName' type='s' access='read'/>"
+    "  <property name='Version' type='s' access='read'/>"
+    "  <property name='AtspiVersion' type='s' access='read'/>"
+    " </interface>"
+    " <interface name='org.a11y.atspi.Cache'>"
+    "  <method name='GetItems'><arg direction='out' type='a((so)(so)(so)iiassusau)'/></method>"
+    " </interface>"
+    "</node>";
+
+static GDBusNodeInfo *introspection;
+static GDBusInterfaceInfo *iface_accessible, *iface_component,
+                          *iface_application, *iface_cache;
+
+static void introspection_load(void) {
+    introspection = g_dbus_node_info_new_for_xml(introspection_xml, NULL);
+    iface_accessible = g_dbus_node_info_lookup_interface(introspection, "org.a11y.atspi.Accessible");
+    iface_component = g_dbus_node_info_lookup_interface(introspection, "org.a11y.atspi.Component");
+    iface_application = g_dbus_node_info_lookup_interface(introspection, "org.a11y.atspi.Application");
+    iface_cache = g_dbus_node_info_lookup_interface(introspection, "org.a11y.atspi.Cache");
+}
+
+static GDBusConnection *bus_connect(void) {
+    const char *addr = getenv("AT_SPI_BUS_ADDRESS");
+    if (!addr) {
+        fprintf(stderr, "[mock] AT_SPI_BUS_ADDRESS is not set\n");
+        exit(1);
+    }
+    GError *err = NULL;
+    GDBusConnection *c = g_dbus_connection_new_for_address_sync(addr,
+                             G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                             G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                             NULL, NULL, &err);
+    if (!c) {
+        fprintf(stderr, "[mock] cannot connect to %s: %s\n", addr, err->message);
+        exit(1);
+    }
+    return c;
+}
+
+/* nodes travel as user_data: 1 is the app root, i + 2 is node i */
+#define NODE_ROOT (-1)
+#define NODE_PTR(i) GINT_TO_POINTER((i) + 2)
+#define PTR_NODE(p) (GPOINTER_TO_INT(p) - 2)
+
+static GVariant *node_ref(int i) {
+    char path[64];
+    node_path(i, path, sizeof(path));
+    return g_variant_new("(so)", me.bus, path);
+}
+
+static GVariant *node_parent_ref(int i) {
+    if (i == NODE_ROOT)
+        return g_variant_new("(so)", "org.a11y.atspi.Registry", root_path);
+    return node_ref(i == 0 ? NODE_ROOT : (i - 1) / opt.fanout);
+}
+
+static int node_child_count(int i) {
+    return i == NODE_ROOT ? 1 : node_children(i);
+}
+
+static int node_child(int i, int k) {
+    return i == NODE_ROOT ? 0 : i * opt.fanout + 1 + k;
+}
+
+static GVariant *node_interfaces(int i) {
+    const char *ifaces[4] = { "org.a11y.atspi.Accessible", NULL, NULL, NULL };
+    if (i == NODE_ROOT) {
+        ifaces[1] = "org.a11y.atspi.Application";
+    } else {
+        ifaces[1] = "org.a11y.atspi.Component";
+        if (node_clickable(i)) ifaces[2] = "org.a11y.atspi.Action";
+    }
+    return g_variant_new_strv(ifaces, -1);
+}
+
+static GVariant *node_state_variant(int i) {
+    guint32 st[2] = { BIT(STATE_VISIBLE) | BIT(STATE_SHOWING), 0 };
+    if (i != NODE_ROOT) node_states(i, st);
+    return g_variant_new_fixed_array(G_VARIANT_TYPE_UINT32, st, 2, sizeof(guint32));
+}
+
+static void app_method(GDBusConnection *conn, const gchar *sender,
+                       const gchar *path, const gchar *iface,
+                       const gchar *method, GVariant *params,
+                       GDBusMethodInvocation *inv, gpointer data)
+{
+    int i = PTR_NODE(data);
+
+    if (strcmp(method, "GetRole") == 0) {
+        guint32 role = i == NODE_ROOT ? ROLE_APPLICATION : node_role(i);
+        g_dbus_method_invocation_return_value(inv, g_variant_new("(u)", role));
+    } else if (strcmp(method, "GetState") == 0) {
+        g_dbus_method_invocation_return_value(inv,
+            g_variant_new("(@au)", node_state_variant(i)));
+    } else if (strcmp(method, "GetChildAtIndex") == 0) {
+        gint32 k;
+        g_variant_get(params, "(i)", &k);
+        if (k < 0 || k >= node_child_count(i)) {
+            g_dbus_method_invocation_return_value(inv,
+                g_variant_new("((so))", "", "/org/a11y/atspi/null"));
+            return;
+        }
+        g_dbus_method_invocation_return_value(inv,
+            g_variant_new("(@(so))", node_ref(node_child(i, k))));
+    } else if (strcmp(method, "GetChildren") == 0) {
+        GVariantBuilder b;
+        g_variant_builder_init(&b, G_VARIANT_TYPE("a(so)"));
+        for (int k = 0; k < node_child_count(i); k++)
+            g_variant_builder_add_value(&b, node_ref(node_child(i, k)));
+        g_dbus_method_invocation_return_value(inv, g_variant_new("(a(so))", &b));
+    } else if (strcmp(method, "GetIndexInParent") == 0) {
+        int idx = i <= 0 ? 0 : (i - 1) % opt.fanout;
+        g_dbus_method_invocation_return_value(inv, g_variant_new("(i)", idx));
+    } else if (strcmp(method, "GetInterfaces") == 0) {
+        g_dbus_method_invocation_return_value(inv,
+            g_variant_new("(@as)", node_interfaces(i)));
+    } else if (strcmp(method, "GetApplication") == 0) {
+        g_dbus_method_invocation_return_value(inv,
+            g_variant_new("(@(so))", node_ref(NODE_ROOT)));
+    } else if (strcmp(method, "GetExtents") == 0 && i != NODE_ROOT) {
+        int r[4];
+        node_extents(i, r);
+        g_dbus_method_invocation_return_value(inv,
+            g_variant_new("((iiii))", r[0], r[1], r[2], r[3]));
+    } else {
+        g_dbus_method_invocation_return_error(inv, G_DBUS_ERROR,
+            G_DBUS_ERROR_UNKNOWN_METHOD, "%s.%s not mocked", iface, method);
+    }
+}
+
+static GVariant *app_property(GDBusConnection *conn, const gchar *sender,
+                              const gchar *path, const gchar *iface,
+                              const gchar *prop, GError **error, gpointer data)
+{
+    int i = PTR_NODE(data);
+    char buf[64];
+
+    if (strcmp(prop, "Name") == 0) {
+        if (i == NODE_ROOT) snprintf(buf, sizeof(buf), "mock%d", me.index);
+        else node_name(i, buf, sizeof(buf));
+        return g_variant_new_string(buf);
+    }
+    if (strcmp(prop, "ChildCount") == 0) return g_variant_new_int32(node_child_count(i));
+    if (strcmp(prop, "Parent") == 0) return node_parent_ref(i);
+    if (strcmp(prop, "ToolkitName") == 0) return g_variant_new_string("mock");
+    if (strcmp(prop, "AtspiVersion") == 0) return g_variant_new_string("2.1");
+    if (strcmp(prop, "Locale") == 0) return g_variant_new_string("C");
+    return g_variant_new_string("");
+}
+
+static const GDBusInterfaceVTable app_vtable = { app_method, app_property, NULL };
+
+/* every node is served by one subtree handler; nothing is enumerated,
+ * 50k children would only make introspection slow */
+static gchar **app_enumerate(GDBusConnection *conn, const gchar *sender,
+                             const gchar *path, gpointer data)
+{
+    return g_new0(gchar *, 1);
+}
+
+static gboolean app_parse_node(const gchar *node, int *i) {
+    if (!node) return FALSE;
+    if (strcmp(node, "root") == 0) { *i = NODE_ROOT; return TRUE; }
+    char *end;
+    long v = strtol(node, &end, 10);
+    if (*end || end == node || v < 0 || v >= me.n) return FALSE;
+    *i = (int)v;
+    return TRUE;
+}
+
+static GDBusInterfaceInfo **app_introspect(GDBusConnection *conn, const gchar *sender,
+                                           const gchar *path, const gchar *node,
+                                           gpointer data)
+{
+    int i;
+    if (!app_parse_node(node, &i)) return NULL;
+    GDBusInterfaceInfo **out = g_new0(GDBusInterfaceInfo *, 3);
+    out[0] = g_dbus_interface_info_ref(iface_accessible);
+    out[1] = g_dbus_interface_info_ref(i == NODE_ROOT ? iface_application : iface_component);
+    return out;
+}
+
+static const GDBusInterfaceVTable *app_dispatch(GDBusConnection *conn,
+                                                const gchar *sender,
+                                                const gchar *path,
+                                                const gchar *iface,
+                                                const gchar *node,
+                                                gpointer *out_data, gpointer data)
+{
+    int i;
+    if (!app_parse_node(node, &i)) return NULL;
+    *out_data = NODE_PTR(i);
+    return &app_vtable;
+}
+
+static const GDBusSubtreeVTable app_subtree = {
+    app_enumerate, app_introspect, app_dispatch,
+};
+
+/* the whole tree in one reply, at-spi2 >= 2.46 layout */
+static void cache_item(GVariantBuilder *b, int i) {
+    char path[64], parent[64], name[64];
+    const char *parent_bus = me.bus;
+    node_path(i, path, sizeof(path));
+    if (i == NODE_ROOT) {
+        parent_bus = "org.a11y.atspi.Registry";
+        snprintf(parent, sizeof(parent), "%s", root_path);
+        snprintf(name, sizeof(name), "mock%d", me.index);
+    } else {
+        node_path(i == 0 ? NODE_ROOT : (i - 1) / opt.fanout, parent, sizeof(parent));
+        node_name(i, name, sizeof(name));
+    }
+    g_variant_builder_add(b, "((so)(so)(so)ii@assus@au)",
+                          me.bus, path, me.bus, root_path, parent_bus, parent,
+                          i <= 0 ? 0 : (i - 1) % opt.fanout, node_child_count(i),
+                          node_interfaces(i), name,
+                          i == NODE_ROOT ? ROLE_APPLICATION : node_role(i),
+                          "", node_state_variant(i));
+}
+
+static void cache_method(GDBusConnection *conn, const gchar *sender,
+                         const gchar *path, const gchar *iface,
+                         const gchar *method, GVariant *params,
+                         GDBusMethodInvocation *inv, gpointer data)
+{
+    GVariantBuilder b;
+    g_variant_builder_init(&b, G_VARIANT_TYPE("a((so)(so)(so)iiassusau)"));
+    cache_item(&b, NODE_ROOT);
+    for (int i = 0; i < me.n; i++) cache_item(&b, i);
+    g_dbus_method_invocation_return_value(inv,
+        g_variant_new("(a((so)(so)(so)iiassusau))", &b));
+}
+
+static const GDBusInterfaceVTable cache_vtable = { cache_method, NULL, NULL };
+
+/* ------------------------------------------------------------------ */
+/*  apps                                                               */
+/* ------------------------------------------------------------------ */
+
+/* serve app i forever; its bus name goes out on fd */
+static void app_main(int i, int fd) {
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    app_layout(i);
+    introspection_load();
+
+    GDBusConnection *conn = bus_connect();
+    me.bus = g_dbus_connection_get_unique_name(conn);
+    GError *err = NULL;
+    if (!g_dbus_connection_register_subtree(conn, "/org/a11y/atspi/accessible",
+                                            &app_subtree,
+                                            G_DBUS_SUBTREE_FLAGS_DISPATCH_TO_UNENUMERATED_NODES,
+                                            NULL, NULL, &err) ||
+        !g_dbus_connection_register_object(conn, "/org/a11y/atspi/cache", iface_cache,
+                                           &cache_vtable, NULL, NULL, &err)) {
+        fprintf(stderr, "[mock] app %d: %s\n", i, err->message);
+        exit(1);
+    }
+
+    dprintf(fd, "%s\n", me.bus);
+    close(fd);
+    g_main_loop_run(g_main_loop_new(NULL, FALSE));
+}
+
+/* ------------------------------------------------------------------ */
+/*  registry — the desktop and its apps                                */
+/* ------------------------------------------------------------------ */
+
+static char **app_bus;   /* unique name per app */
+static pid_t *app_pid;
+
+static GVariant *desktop_child(int k) {
+    return g_variant_new("(so)", app_bus[k], root_path);
+}
+
+static void desktop_method(GDBusConnection *conn, const gchar *sender,
+                           const gchar *path, const gchar *iface,
+                           const gchar *method, GVariant *params,
+                           GDBusMethodInvocation *inv, gpointer data)
+{
+    if (strcmp(method, "GetRole") == 0) {
+        g_dbus_method_invocation_return_value(inv, g_variant_new("(u)", ROLE_DESKTOP_FRAME));
+    } else if (strcmp(method, "GetState") == 0) {
+        guint32 st[2] = { BIT(STATE_VISIBLE) | BIT(STATE_SHOWING) | BIT(STATE_ENABLED), 0 };
+        g_dbus_method_invocation_return_value(inv, g_variant_new("(@au)",
+            g_variant_new_fixed_array(G_VARIANT_TYPE_UINT32, st, 2, sizeof(guint32))));
+    } else if (strcmp(method, "GetChildAtIndex") == 0) {
+        gint32 k;
+        g_variant_get(params, "(i)", &k);
+        if (k < 0 || k >= opt.apps)
+            g_dbus_method_invocation_return_value(inv,
+                g_variant_new("((so))", "", "/org/a11y/atspi/null"));
+        else
+            g_dbus_method_invocation_return_value(inv,
+                g_variant_new("(@(so))", desktop_child(k)));
+    } else if (strcmp(method, "GetChildren") == 0) {
+        GVariantBuilder b;
+        g_variant_builder_init(&b, G_VARIANT_TYPE("a(so)"));
+        for (int k = 0; k < opt.apps; k++) g_variant_builder_add_value(&b, desktop_child(k));
+        g_dbus_method_invocation_return_value(inv, g_variant_new("(a(so))", &b));
+    } else if (strcmp(method, "GetIndexInParent") == 0) {
+        g_dbus_method_invocation_return_value(inv, g_variant_new("(i)", -1));
+    } else if (strcmp(method, "GetInterfaces") == 0) {
+        const char *ifaces[] = { "org.a11y.atspi.Accessible", NULL };
+        g_dbus_method_invocation_return_value(inv,
+            g_variant_new("(@as)", g_variant_new_strv(ifaces, -1)));
+    } else {
+        g_dbus_method_invocation_return_error(inv, G_DBUS_ERROR,
+            G_DBUS_ERROR_UNKNOWN_METHOD, "%s.%s not mocked", iface, method);
+    }
+}
+
+static GVariant *desktop_property(GDBusConnection *conn, const gchar *sender,
+                                  const gchar *path, const gchar *iface,
+                                  const gchar *prop, GError **error, gpointer data)
+{
+    if (strcmp(prop, "Name") == 0) return g_variant_new_string("main");
+    if (strcmp(prop, "ChildCount") == 0) return g_variant_new_int32(opt.apps);
+    if (strcmp(prop, "Parent") == 0) return g_variant_new("(so)", "", "/org/a11y/atspi/null");
+    return g_variant_new_string("");
+}
+
+static const GDBusInterfaceVTable desktop_vtable = {
+    desktop_method, desktop_property, NULL,
+};
+
+/* ------------------------------------------------------------------ */
+/*  fake hyprland socket                                               */
+/* ------------------------------------------------------------------ */
+
+static void client_json(GString *o, int i) {
+    int x, y, w, h;
+    char title[64];
+    app_geom(i, &x, &y, &w, &h);
+    app_title(i, title, sizeof(title));
+    g_string_append_printf(o,
+        "{\"address\":\"0x%x\",\"mapped\":true,\"hidden\":false,"
+        "\"at\":[%d,%d],\"size\":[%d,%d],\"workspace\":{\"id\":1,\"name\":\"1\"},"
+        "\"floating\":false,\"monitor\":0,\"class\":\"mock%d\",\"title\":\"%s\","
+        "\"pid\":%d,\"xwayland\":false}",
+        0x1000 + i, x, y, w, h, i, title, (int)app_pid[i]);
+}
+
+static GString *hypr_reply(const char *req) {
+    GString *o = g_string_new(NULL);
+    if (strcmp(req, "j/clients") == 0) {
+        g_string_append_c(o, '[');
+        for (int i = 0; i < opt.apps; i++) {
+            if (i) g_string_append_c(o, ',');
+            client_json(o, i);
+        }
+        g_string_append_c(o, ']');
+    } else if (strcmp(req, "j/activewindow") == 0) {
+        client_json(o, 0);
+    } else if (strcmp(req, "j/monitors") == 0) {
+        g_string_append_printf(o,
+            "[{\"id\":0,\"name\":\"MOCK-1\",\"width\":%d,\"height\":%d,"
+            "\"x\":0,\"y\":0,\"scale\":1.00,\"focused\":true}]", SCREEN_W, SCREEN_H);
+    } else if (strcmp(req, "j/cursorpos") == 0) {
+        int x, y, w, h;
+        app_geom(0, &x, &y, &w, &h);
+        g_string_append_printf(o, "{\"x\":%d,\"y\":%d}", x + w / 2, y + h / 2);
+    } else {
+        g_string_append(o, "unknown request");
+    }
+    return o;
+}
+
+static gboolean on_hypr_client(gint fd, GIOCondition cond, gpointer data) {
+    int c = accept(fd, NULL, NULL);
+    if (c < 0) return G_SOURCE_CONTINUE;
+
+    char req[256];
+    ssize_t n = read(c, req, sizeof(req) - 1);
+    if (n > 0) {
+        req[n] = '\0';
+        GString *o = hypr_reply(req);
+        for (gsize off = 0; off < o->len; ) {
+            ssize_t w = write(c, o->str + off, o->len - off);
+            if (w <= 0) break;
+            off += w;
+        }
+        g_string_free(o, TRUE);
+    }
+    close(c);
+    return G_SOURCE_CONTINUE;
+}
+
+static char hypr_sock[256];
+
+static int hypr_listen(void) {
+    g_mkdir_with_parents(opt.hypr, 0700);
+    snprintf(hypr_sock, sizeof(hypr_sock), "%s/.socket.sock", opt.hypr);
+    unlink(hypr_sock);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, hypr_sock, sizeof(addr.sun_path) - 1);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(fd, 16) < 0) {
+        fprintf(stderr, "[mock] cannot listen on %s\n", hypr_sock);
+        exit(1);
+    }
+    return fd;
+}
+
+/* ------------------------------------------------------------------ */
+/*  main                                                               */
+/* ------------------------------------------------------------------ */
+
+static gboolean on_quit(gpointer data) {
+    g_main_loop_quit(data);
+    return G_SOURCE_REMOVE;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: mock --hypr=DIR [--nodes=N] [--apps=N] [--fanout=N | --depth=N]\n"
+        "            [--gtk4=N] [--chromium=N] [--clickable=PCT] [--pages=N]\n");
+    exit(2);
+}
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strncmp(a, "--nodes=", 8) == 0) opt.nodes = atoi(a + 8);
+        else if (strncmp(a, "--apps=", 7) == 0) opt.apps = atoi(a + 7);
+        else if (strncmp(a, "--fanout=", 9) == 0) opt.fanout = atoi(a + 9);
+        else if (strncmp(a, "--depth=", 8) == 0) opt.depth = atoi(a + 8);
+        else if (strncmp(a, "--gtk4=", 7) == 0) opt.gtk4 = atoi(a + 7);
+        else if (strncmp(a, "--chromium=", 11) == 0) opt.chromium = atoi(a + 11);
+        else if (strncmp(a, "--clickable=", 12) == 0) opt.clickable = atoi(a + 12);
+        else if (strncmp(a, "--pages=", 8) == 0) opt.pages = atoi(a + 8);
+        else if (strncmp(a, "--hypr=", 7) == 0) opt.hypr = a + 7;
+        else usage();
+    }
+    if (!opt.hypr || opt.apps < 1 || opt.nodes < 1 || opt.pages < 1) usage();
+
+    /* smallest fan-out that fits the nodes into depth levels */
+    if (opt.depth > 0) {
+        int per_app = MAX(opt.nodes / opt.apps, 2);
+        for (opt.fanout = 2; ; opt.fanout++) {
+            double total = 0, level = 1;
+            for (int d = 0; d <= opt.depth; d++, level *= opt.fanout) total += level;
+            if (total >= per_app) break;
+        }
+    }
+    if (opt.fanout < 1) usage();
+
+    /* apps first, while this process has no threads */
+    app_bus = g_new0(char *, opt.apps);
+    app_pid = g_new0(pid_t, opt.apps);
+    for (int i = 0; i < opt.apps; i++) {
+        int p[2];
+        if (pipe(p) < 0) return 1;
+        app_pid[i] = fork();
+        if (app_pid[i] < 0) return 1;
+        if (app_pid[i] == 0) {
+            close(p[0]);
+            app_main(i, p[1]);
+            _exit(0);
+        }
+        close(p[1]);
+        FILE *f = fdopen(p[0], "r");
+        char name[256];
+        if (!fgets(name, sizeof(name), f)) {
+            fprintf(stderr, "[mock] app %d didn't start\n", i);
+            return 1;
+        }
+        name[strcspn(name, "\n")] = '\0';
+        app_bus[i] = g_strdup(name);
+        fclose(f);
+    }
+
+    introspection_load();
+    GDBusConnection *conn = bus_connect();
+    GError *err = NULL;
+    if (!g_dbus_connection_register_object(conn, root_path, iface_accessible,
+                                           &desktop_vtable, NULL, NULL, &err)) {
+        fprintf(stderr, "[mock] registry: %s\n", err->message);
+        return 1;
+    }
+    GVariant *r = g_dbus_connection_call_sync(conn, "org.freedesktop.DBus",
+                      "/org/freedesktop/DBus", "org.freedesktop.DBus", "RequestName",
+                      g_variant_new("(su)", "org.a11y.atspi.Registry", 4u /* DO_NOT_QUEUE */),
+                      G_VARIANT_TYPE("(u)"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, &err);
+    guint32 rc = 0;
+    if (r) {
+        g_variant_get(r, "(u)", &rc);
+        g_variant_unref(r);
+    }
+    if (rc != 1) {  /* PRIMARY_OWNER */
+        fprintf(stderr, "[mock] cannot own org.a11y.atspi.Registry\n");
+        return 1;
+    }
+
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    g_unix_fd_add(hypr_listen(), G_IO_IN, on_hypr_client, NULL);
+    g_unix_signal_add(SIGTERM, on_quit, loop);
+    g_unix_signal_add(SIGINT, on_quit, loop);
+
+    fprintf(stderr, "[mock] %d apps, %d nodes each, fan-out %d\n",
+            opt.apps, MAX(opt.nodes / opt.apps, 2), opt.fanout);
+    printf("ready\n");
+    fflush(stdout);
+    g_main_loop_run(loop);
+
+    unlink(hypr_sock);
+    for (int i = 0; i < opt.apps; i++) kill(app_pid[i], SIGTERM);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#!/bin/sh
+# make bench: time wlim --bench against mock desktops of growing size.
+#
+# everything runs on a private bus and a fake hyprland socket in a temp
+# dir, so the real desktop, config and click history are never touched.
+#
+#   BENCH_SIZES   total nodes per run      (100 1000 5000 10000 20000 50000)
+#   BENCH_RUNS    collections per size     (20)
+#   BENCH_MOCK    extra bench/mock options (--apps=4 --gtk4=1 --chromium=1)
+#   BENCH_WLIM    extra wlim options, e.g. --walker=items
+#   BENCH_JSON    also append wlim's raw lines to this file
+set -eu
+cd "$(dirname "$0")/.."
+
+sizes=${BENCH_SIZES:-100 1000 5000 10000 20000 50000}
+runs=${BENCH_RUNS:-20}
+mock_args=${BENCH_MOCK:---apps=4 --gtk4=1 --chromium=1}
+wlim_args=${BENCH_WLIM:-}
+
+tmp=$(mktemp -d)
+bus_pid=
+mock_pid=
+cleanup() {
+    [ -n "$mock_pid" ] && kill "$mock_pid" 2>/dev/null
+    [ -n "$bus_pid" ] && kill "$bus_pid" 2>/dev/null
+    rm -rf "$tmp"
+}
+trap cleanup EXIT INT TERM
+
+dbus-daemon --session --address="unix:path=$tmp/bus" --nofork --nopidfile &
+bus_pid=$!
+while [ ! -S "$tmp/bus" ]; do sleep 0.05; done
+
+export AT_SPI_BUS_ADDRESS="unix:path=$tmp/bus"
+export DBUS_SESSION_BUS_ADDRESS="$AT_SPI_BUS_ADDRESS"
+export XDG_RUNTIME_DIR="$tmp"
+export XDG_CONFIG_HOME="$tmp/config"
+export XDG_STATE_HOME="$tmp/state"
+export XDG_CACHE_HOME="$tmp/cache"
+export HYPRLAND_INSTANCE_SIGNATURE=bench
+
+printf '%s runs per size, times in ms\n' "$runs"
+printf '%7s %7s %9s %9s %9s %9s %9s %9s\n' nodes targets \
+    collect50 collect99 labels50 labels99 filter50 filter99
+
+for n in $sizes; do
+    # shellcheck disable=SC2086
+    bench/mock --hypr="$tmp/hypr/bench" --nodes="$n" $mock_args \
+        > "$tmp/ready" 2>> "$tmp/log" &
+    mock_pid=$!
+    until grep -q ready "$tmp/ready"; do
+        if ! kill -0 "$mock_pid" 2>/dev/null; then
+            echo "bench: mock didn't start" >&2
+            cat "$tmp/log" >&2
+            exit 1
+        fi
+        sleep 0.05
+    done
+
+    # shellcheck disable=SC2086
+    line=$(./wlim --bench="$runs" $wlim_args 2>> "$tmp/log" || true)
+    kill "$mock_pid" 2>/dev/null
+    wait "$mock_pid" 2>/dev/null || true
+    mock_pid=
+
+    if [ -z "$line" ]; then
+        echo "bench: wlim failed at $n nodes" >&2
+        tail -n 20 "$tmp/log" >&2
+        exit 1
+    fi
+    [ -n "${BENCH_JSON:-}" ] && printf '{"nodes":%s,%s\n' "$n" "${line#\{}" >> "$BENCH_JSON"
+
+    echo "$line" | sed -n 's/.*"targets":\([0-9]*\).*"collect":{"p50":\([0-9]*\),"p99":\([0-9]*\)}.*"labels":{"p50":\([0-9]*\),"p99":\([0-9]*\)}.*"filter":{"p50":\([0-9]*\),"p99":\([0-9]*\)}.*/\1 \2 \3 \4 \5 \6 \7/p' |
+        awk -v n="$n" '{ printf "%7d %7d %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                         n, $1, $2/1000, $3/1000, $4/1000, $5/1000, $6/1000, $7/1000 }'
+done
@@ -1,10 +1,10 @@
 /*
  * wlim — vimium-like click hints for wayland (hyprland)
  *
- * walks the AT-SPI2 accessibility tree of all visible windows,
- * draws labeled hints over every clickable element using a
- * GTK4 + gtk4-layer-shell overlay, and clicks via uinput
- * when you type a hint.
+ * walks the AT-SPI2 accessibility tree of the focused window, then
+ * of every other visible window in the background, draws labeled
+ * hints over every clickable element using a GTK4 + gtk4-layer-shell
+ * overlay, and clicks via uinput when you type a hint.
  *
  * build:
  *   make
@@ -13,30 +13,47 @@
  */
 
 #include <gtk/gtk.h>
+#include <glib-unix.h>
 #include <gtk4-layer-shell.h>
 #include <atspi/atspi.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/wait.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
 #include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/prctl.h>
 #include <linux/uinput.h>
 #include <linux/input-event-codes.h>
 
-#define MAX_TARGETS  1024
-#define MAX_LABEL    4
+#define MAX_LABEL    6
+#define MAX_NAME     127
 #define MAX_TYPED    8
 
 /* ------------------------------------------------------------------ */
 /*  configuration                                                      */
 /* ------------------------------------------------------------------ */
 
+enum { WALKER_RECURSIVE, WALKER_COLLECTION, WALKER_ITEMS };
+enum { DEDUP_CENTER, DEDUP_IOU };
+enum { RENDER_LABELS, RENDER_CANVAS };
+enum { LABELS_FIXED, LABELS_WEIGHTED };
+enum { SAME_FINGER_ALLOW, SAME_FINGER_AVOID };
+
+#define HINT_CHARS_DEFAULT "abcdefghijklmnopqrstuvwxyz"
+#define DEDUP_IOU_MIN      0.1   /* keeps the dedup grid search bounded */
+
 static struct {
     char hint_bg[32];
     char hint_fg[32];
@@ -47,6 +64,21 @@ static struct {
     int  scroll_speed;      /* ticks per j/k press */
     int  page_speed;        /* ticks per d/u press */
     int  jump_speed;        /* ticks per G/gg */
+    int  cache_max_age;     /* daemon target cache lifetime, seconds (0 = off) */
+    int  snapshot_max_age;  /* seconds a window's last targets may be shown for (0 = off) */
+    int  prewalk_budget;    /* daemon: ms a focus-change walk may take (0 = off) */
+    int  walker;            /* WALKER_RECURSIVE, WALKER_COLLECTION or WALKER_ITEMS */
+    int  walk_workers;      /* processes walking apps in parallel (0 = off) */
+    int  call_timeout;      /* ms an app gets to answer one AT-SPI call (0 = libatspi's) */
+    int  app_budget;        /* ms walking one app may take before it's skipped (0 = off) */
+    int  dedup;             /* DEDUP_CENTER or DEDUP_IOU */
+    int  dedup_tolerance;   /* max center distance in px for DEDUP_CENTER */
+    double dedup_iou;       /* min overlap ratio for DEDUP_IOU */
+    int  renderer;          /* RENDER_LABELS or RENDER_CANVAS */
+    int  labels;            /* LABELS_FIXED or LABELS_WEIGHTED */
+    char hint_chars[64];    /* keys labels are made of, most preferred first */
+    int  same_finger;       /* SAME_FINGER_ALLOW or SAME_FINGER_AVOID */
+    int  history_half_life; /* days for a remembered click to count half (0 = off) */
 } cfg = {
     .hint_bg           = "#2a2a2a",
     .hint_fg           = "#e0e0e0",
@@ -57,6 +89,21 @@ static struct {
     .scroll_speed      = 1,
     .page_speed        = 10,
     .jump_speed        = 200,
+    .cache_max_age     = 30,
+    .snapshot_max_age  = 600,
+    .prewalk_budget    = 1000,
+    .walker            = WALKER_RECURSIVE,
+    .walk_workers      = 4,
+    .call_timeout      = 1000,
+    .app_budget        = 2000,
+    .dedup             = DEDUP_CENTER,
+    .dedup_tolerance   = 4,
+    .dedup_iou         = 0.8,
+    .renderer          = RENDER_LABELS,
+    .labels            = LABELS_WEIGHTED,
+    .hint_chars        = HINT_CHARS_DEFAULT,
+    .same_finger       = SAME_FINGER_AVOID,
+    .history_half_life = 14,
 };
 
 static void cfg_set(const char *key, const char *val) {
@@ -69,6 +116,27 @@ static void cfg_set(const char *key, const char *val) {
     else if (strcmp(key, "scroll_speed") == 0) cfg.scroll_speed = atoi(val);
     else if (strcmp(key, "page_speed") == 0) cfg.page_speed = atoi(val);
     else if (strcmp(key, "jump_speed") == 0) cfg.jump_speed = atoi(val);
+    else if (strcmp(key, "cache_max_age") == 0) cfg.cache_max_age = atoi(val);
+    else if (strcmp(key, "snapshot_max_age") == 0) cfg.snapshot_max_age = atoi(val);
+    else if (strcmp(key, "prewalk_budget") == 0) cfg.prewalk_budget = atoi(val);
+    else if (strcmp(key, "walk_workers") == 0) cfg.walk_workers = atoi(val);
+    else if (strcmp(key, "call_timeout") == 0) cfg.call_timeout = atoi(val);
+    else if (strcmp(key, "app_budget") == 0) cfg.app_budget = atoi(val);
+    else if (strcmp(key, "walker") == 0)
+        cfg.walker = strcmp(val, "collection") == 0 ? WALKER_COLLECTION
+                   : strcmp(val, "items") == 0 ? WALKER_ITEMS : WALKER_RECURSIVE;
+    else if (strcmp(key, "dedup") == 0)
+        cfg.dedup = strcmp(val, "iou") == 0 ? DEDUP_IOU : DEDUP_CENTER;
+    else if (strcmp(key, "dedup_tolerance") == 0) cfg.dedup_tolerance = atoi(val);
+    else if (strcmp(key, "dedup_iou") == 0) cfg.dedup_iou = CLAMP(atof(val), DEDUP_IOU_MIN, 1.0);
+    else if (strcmp(key, "renderer") == 0)
+        cfg.renderer = strcmp(val, "canvas") == 0 ? RENDER_CANVAS : RENDER_LABELS;
+    else if (strcmp(key, "labels") == 0)
+        cfg.labels = strcmp(val, "fixed") == 0 ? LABELS_FIXED : LABELS_WEIGHTED;
+    else if (strcmp(key, "hint_chars") == 0) strncpy(cfg.hint_chars, val, sizeof(cfg.hint_chars) - 1);
+    else if (strcmp(key, "hint_same_finger") == 0)
+        cfg.same_finger = strcmp(val, "allow") == 0 ? SAME_FINGER_ALLOW : SAME_FINGER_AVOID;
+    else if (strcmp(key, "history_half_life") == 0) cfg.history_half_life = atoi(val);
 }
 
 static void cfg_load(void) {
@@ -115,6 +183,88 @@ static void cfg_load(void) {
     fprintf(stderr, "[wlim] loaded config from %s\n", path);
 }
 
+/* ------------------------------------------------------------------ */
+/*  run statistics — --stats                                           */
+/* ------------------------------------------------------------------ */
+
+/* with --stats every run (every trigger, in the daemon) ends with one
+ * JSON line on stdout saying where the time went: when each phase was
+ * reached, in ms since the run started, how long hyprctl, labeling,
+ * rendering, keystrokes and the click took, and what walking each app
+ * and window cost. one line per run so they can be collected and
+ * compared across machines and versions. */
+enum {
+    PHASE_CONFIG, PHASE_ATSPI, PHASE_OVERLAY, PHASE_FOCUS, PHASE_FIRST_FRAME,
+    PHASE_COLLECTED, PHASE_CHOSEN, PHASE_CLICKED, PHASE_COUNT
+};
+
+static const char *const phase_names[PHASE_COUNT] = {
+    "config", "atspi_init", "overlay_built", "focus_walked", "first_frame",
+    "collected", "chosen", "clicked",
+};
+
+static struct {
+    gboolean on;
+    gboolean daemon;
+    gboolean emitted;           /* this run's line is out */
+    gint64   start_us;
+    gint64   at[PHASE_COUNT];   /* µs after start_us, 0 = not reached */
+    guint    hypr_calls;
+    gint64   hypr_us;
+    gint64   labels_us;
+    gint64   render_us;
+    guint    keys;
+    gint64   keys_us;
+    gint64   click_us;
+    int      targets;
+    gint64   walk_us;           /* summed over windows, across processes */
+    guint    walk_api_calls, walk_visited, walk_culled;
+    gboolean prewalk_on;        /* daemon walking focused windows ahead of triggers */
+    gboolean prewalk_ready;     /* ...and it had this trigger's snapshot ready */
+    guint    prewalk_hits, prewalk_triggers;
+    GString *apps;              /* json objects of the apps walked so far */
+} stats;
+
+static void stats_begin(gint64 start_us) {
+    if (!stats.on) return;
+    GString *apps = stats.apps;
+    gboolean daemon = stats.daemon;
+    memset(&stats, 0, sizeof(stats));
+    stats.on = TRUE;
+    stats.daemon = daemon;
+    stats.start_us = start_us;
+    stats.apps = apps ? apps : g_string_new(NULL);
+    g_string_truncate(stats.apps, 0);
+}
+
+static void stats_mark(int phase) {
+    if (stats.on && !stats.at[phase])
+        stats.at[phase] = MAX(1, g_get_monotonic_time() - stats.start_us);
+}
+
+/* s as a json string. apps don't always hand out valid utf-8; bad
+ * bytes become U+FFFD so the line still parses */
+static void json_str(GString *out, const char *s) {
+    g_string_append_c(out, '"');
+    for (const unsigned char *p = (const unsigned char *)(s ? s : ""); *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            g_string_append_c(out, '\\');
+            g_string_append_c(out, (char)*p);
+        } else if (*p < 0x20) {
+            g_string_append_printf(out, "\\u%04x", *p);
+        } else if (*p < 0x80) {
+            g_string_append_c(out, (char)*p);
+        } else if ((gint)g_utf8_get_char_validated((const char *)p, -1) < 0) {
+            g_string_append(out, "\\ufffd");
+        } else {
+            const char *next = g_utf8_next_char(p);
+            g_string_append_len(out, (const char *)p, next - (const char *)p);
+            p = (const unsigned char *)next - 1;
+        }
+    }
+    g_string_append_c(out, '"');
+}
+
 /* lookup table for clickable roles */
 static gboolean clickable_lut[256];
 
@@ -135,21 +285,264 @@ static void init_clickable_lut(void) {
         if ((int)roles[i] < 256) clickable_lut[(int)roles[i]] = TRUE;
 }
 
+/* ------------------------------------------------------------------ */
+/*  target store                                                       */
+/* ------------------------------------------------------------------ */
+
+/* targets are kept in one growable array of small fixed-size records
+ * so the filtering loops stay cache-friendly. element names are stored
+ * separately in an append-only string arena and referenced by offset;
+ * identical names are stored once. offset 0 is always "". */
+typedef struct {
+    char    *buf;
+    guint32  len, cap;
+    guint32 *slots;   /* open-addressed intern table, 0 = empty */
+    guint32  nslots, used;
+} StrArena;
+
 typedef struct {
     int x, y, w, h;   /* element bounds from AT-SPI */
     int lx, ly;       /* label display position (top-left of element) */
     int cx, cy;       /* click position (center of element) */
+    guint32 name;     /* element text, offset into the store's names */
+    guint32 hkey;     /* click history key, 0 = none */
+    guint8  role;     /* AtspiRole */
     char label[MAX_LABEL + 1];
-    char name[128];   /* element text from AT-SPI */
 } Target;
 
+typedef struct {
+    Target  *t;
+    int      n, cap;
+    StrArena names;
+    /* spatial hash for duplicate checks: grid cell -> newest target in
+     * it (+1), chained through next[]. targets are indexed lazily, so
+     * `gridded` is how many of t[] are in it. */
+    GHashTable *cells;
+    int        *next;
+    int         gridded;
+} TargetStore;
+
+static void arena_rehash(StrArena *a, guint32 nslots) {
+    g_free(a->slots);
+    a->slots = g_new0(guint32, nslots);
+    a->nslots = nslots;
+    a->used = 0;
+    /* walk the arena and re-insert every string after the leading "" */
+    for (guint32 off = 1; off < a->len; off += strlen(a->buf + off) + 1) {
+        guint32 h = g_str_hash(a->buf + off) & (nslots - 1);
+        while (a->slots[h]) h = (h + 1) & (nslots - 1);
+        a->slots[h] = off;
+        a->used++;
+    }
+}
+
+/* intern s (truncated to at most MAX_NAME bytes, at a character
+ * boundary), returning its offset */
+static guint32 arena_intern(StrArena *a, const char *s) {
+    if (!s || !s[0]) return 0;
+
+    char tmp[MAX_NAME + 1];
+    size_t len = strlen(s);
+    if (len > MAX_NAME) {
+        /* the character byte MAX_NAME is in doesn't fit */
+        const char *cut = g_utf8_find_prev_char(s, s + MAX_NAME + 1);
+        len = cut ? (size_t)(cut - s) : 0;
+        if (len == 0) return 0;
+        memcpy(tmp, s, len);
+        tmp[len] = '\0';
+        s = tmp;
+    }
+
+    if ((a->used + 1) * 2 > a->nslots)
+        arena_rehash(a, a->nslots ? a->nslots * 2 : 64);
+
+    guint32 h = g_str_hash(s) & (a->nslots - 1);
+    while (a->slots[h]) {
+        if (strcmp(a->buf + a->slots[h], s) == 0) return a->slots[h];
+        h = (h + 1) & (a->nslots - 1);
+    }
+
+    if (a->len + len + 1 > a->cap) {
+        while (a->len + len + 1 > a->cap) a->cap = a->cap ? a->cap * 2 : 4096;
+        a->buf = g_realloc(a->buf, a->cap);
+    }
+    guint32 off = a->len;
+    memcpy(a->buf + off, s, len + 1);
+    a->len += len + 1;
+    a->slots[h] = off;
+    a->used++;
+    return off;
+}
+
+static void ts_reset(TargetStore *ts) {
+    ts->n = 0;
+    if (!ts->names.buf) {
+        ts->names.cap = 4096;
+        ts->names.buf = g_malloc(ts->names.cap);
+    }
+    ts->names.buf[0] = '\0';
+    ts->names.len = 1;
+    if (ts->names.nslots) memset(ts->names.slots, 0, ts->names.nslots * sizeof(guint32));
+    ts->names.used = 0;
+    if (ts->cells) g_hash_table_remove_all(ts->cells);
+    ts->gridded = 0;
+}
+
+static void ts_free(TargetStore *ts) {
+    g_free(ts->t);
+    g_free(ts->names.buf);
+    g_free(ts->names.slots);
+    if (ts->cells) g_hash_table_destroy(ts->cells);
+    g_free(ts->next);
+    memset(ts, 0, sizeof(*ts));
+}
+
+static const char *ts_name(const TargetStore *ts, int i) {
+    return ts->names.buf ? ts->names.buf + ts->t[i].name : "";
+}
+
+/* append a zeroed target */
+static Target *ts_push(TargetStore *ts) {
+    if (!ts->names.buf) ts_reset(ts);
+    if (ts->n == ts->cap) {
+        ts->cap = ts->cap ? ts->cap * 2 : 256;
+        ts->t = g_renew(Target, ts->t, ts->cap);
+        ts->next = g_renew(int, ts->next, ts->cap);
+    }
+    Target *t = &ts->t[ts->n++];
+    memset(t, 0, sizeof(*t));
+    return t;
+}
+
+/* append src[from..from+count) to dst, moving names into dst's arena */
+static void ts_append(TargetStore *dst, const TargetStore *src, int from, int count) {
+    for (int i = from; i < from + count; i++) {
+        Target *t = ts_push(dst);
+        *t = src->t[i];
+        t->name = arena_intern(&dst->names, ts_name(src, i));
+    }
+}
+
+/* the grid is keyed by element center. cells are at least as wide as
+ * the center tolerance, so a center-distance check only ever needs the
+ * 3x3 block around the new target.
+ *
+ * for iou there's a grid per size: level l has cells DEDUP_CELL_MIN << l
+ * wide and holds the boxes whose longer side fits one cell. boxes that
+ * overlap at all have centers less than half their sizes added apart,
+ * and iou >= r needs each side within a factor r of the other's, so a
+ * check looks at a few levels and a few cells on each, whatever the
+ * size of the boxes. */
+#define DEDUP_CELL_MIN 16
+#define DEDUP_LEVELS   16
+
+static int dedup_cell(void) {
+    return MAX(cfg.dedup_tolerance, DEDUP_CELL_MIN);
+}
+
+/* the grid level a box of longer side s goes in */
+static int dedup_level(double s) {
+    if (cfg.dedup != DEDUP_IOU) return 0;
+    int l = 0;
+    while (l < DEDUP_LEVELS - 1 && (double)(dedup_cell() << l) < s) l++;
+    return l;
+}
+
+static gpointer dedup_key(int l, int gx, int gy) {
+    return GUINT_TO_POINTER((guint)l << 28 | ((guint)gx & 0x3fff) << 14 | ((guint)gy & 0x3fff));
+}
+
+static void ts_grid_insert(TargetStore *ts, int i) {
+    const Target *t = &ts->t[i];
+    int l = dedup_level(MAX(t->w, t->h));
+    int cell = dedup_cell() << l;
+    gpointer key = dedup_key(l, (t->x + t->w / 2) / cell, (t->y + t->h / 2) / cell);
+    ts->next[i] = GPOINTER_TO_INT(g_hash_table_lookup(ts->cells, key)) - 1;
+    g_hash_table_insert(ts->cells, key, GINT_TO_POINTER(i + 1));
+}
+
+/* drop the index, e.g. after targets were removed or reordered */
+static void ts_grid_invalidate(TargetStore *ts) {
+    if (ts->cells) g_hash_table_remove_all(ts->cells);
+    ts->gridded = 0;
+}
+
+static gboolean dedup_match(const Target *t, int x, int y, int w, int h) {
+    if (cfg.dedup == DEDUP_IOU) {
+        int ix = MIN(t->x + t->w, x + w) - MAX(t->x, x);
+        int iy = MIN(t->y + t->h, y + h) - MAX(t->y, y);
+        if (ix <= 0 || iy <= 0) return FALSE;
+        double inter = (double)ix * iy;
+        double uni = (double)t->w * t->h + (double)w * h - inter;
+        return inter >= cfg.dedup_iou * uni;
+    }
+    return abs((t->x + t->w / 2) - (x + w / 2)) <= cfg.dedup_tolerance &&
+           abs((t->y + t->h / 2) - (y + h / 2)) <= cfg.dedup_tolerance;
+}
+
+/* does a target with these bounds (nearly) coincide with one already in
+ * the store? O(1) per call for any store size. */
+static gboolean ts_overlaps(TargetStore *ts, int x, int y, int w, int h) {
+    if (!ts->cells) ts->cells = g_hash_table_new(g_direct_hash, g_direct_equal);
+    while (ts->gridded < ts->n) ts_grid_insert(ts, ts->gridded++);
+
+    int s = MAX(w, h), lo = 0, hi = 0;
+    if (cfg.dedup == DEDUP_IOU) {
+        lo = dedup_level(s * cfg.dedup_iou);
+        hi = dedup_level(s / cfg.dedup_iou);
+    }
+    for (int l = lo; l <= hi; l++) {
+        int cell = dedup_cell() << l;
+        int reach = cfg.dedup == DEDUP_IOU ? (s + cell) / 2 / cell + 1 : 1;
+        int gx = (x + w / 2) / cell, gy = (y + h / 2) / cell;
+        for (int cy = gy - reach; cy <= gy + reach; cy++)
+            for (int cx = gx - reach; cx <= gx + reach; cx++) {
+                int i = GPOINTER_TO_INT(g_hash_table_lookup(ts->cells, dedup_key(l, cx, cy))) - 1;
+                for (; i >= 0; i = ts->next[i])
+                    if (dedup_match(&ts->t[i], x, y, w, h)) return TRUE;
+            }
+    }
+    return FALSE;
+}
+
+/* see the search index section */
+#define SEARCH_MAX     63      /* longest query */
+#define SEARCH_CLASSES 37      /* a-z, 0-9, everything else */
+
+typedef struct {
+    int *id;
+    int *score;
+    int  n;
+} SearchLevel;
+
+typedef struct {
+    gboolean    built;
+    int         n;
+    char       *folded;        /* lowercased names, NUL separated */
+    guint32    *off;           /* per target: offset into folded */
+    guint64    *mask;          /* per target: character classes present */
+    int        *post;          /* per class: targets containing it */
+    int         post_start[SEARCH_CLASSES + 1];
+    SearchLevel level[SEARCH_MAX + 1];  /* matches per query length */
+    int         depth;         /* levels 1..depth are current */
+    int         shown;         /* level the hints reflect, -1 = all */
+    guint32    *seen;          /* per target stamp, for set differences */
+    guint32     seen_gen;
+} SearchIndex;
+
 typedef struct {
     GtkApplication *app;
     GtkWidget      *win;
     GtkWidget      *fixed;
-    Target  targets[MAX_TARGETS];
-    int     n_targets;
-    GtkWidget *hint_labels[MAX_TARGETS];
+    TargetStore ts;
+    GtkWidget **hint_labels;   /* renderer=labels: one per target */
+    GskRenderNode **hint_nodes; /* renderer=canvas: cached per target */
+    guint8    *hint_vis;       /* per target: hint currently shown */
+    int     hint_cap;
+    GtkWidget *canvas;         /* renderer=canvas: draws every hint */
+    int    *by_label;          /* labeled targets, sorted by label */
+    int     nlabeled;
+    int     range_lo, range_hi; /* by_label slice matching s->typed */
     char    typed[MAX_TYPED + 1];
     int     typed_len;
     int     click_x, click_y;
@@ -158,47 +551,98 @@ typedef struct {
     gboolean search_mode;
     char    search[64];
     int     search_len;
+    SearchIndex sx;
     GtkWidget *search_box;
+    gboolean daemon;       /* --daemon: window is reused, never destroyed */
+    gboolean headless;     /* --bench, --dump: collect and label, no overlay */
+    gboolean dump;         /* --dump: print the targets when collection ends */
+    int     nfocus;        /* targets from the focused window, listed first */
+    GHashTable *pins;      /* "role,cx,cy,name" -> label shown from a snapshot */
+    GArray  *label_space;  /* LabelSlots not handed out yet this session */
+    int     label_missing; /* targets the code space had no room for */
+    TargetStore late;      /* held back by a search past the collection */
+    int     late_nfocus;
+    gboolean active;       /* overlay currently shown */
+    gint64  trigger_us;    /* monotonic time of the trigger, for latency */
+    gint64  shown_us;      /* first frame painted */
+    gint64  chosen_us;     /* hint picked */
+    gint64  unmapped_us;   /* overlay surface unmapped */
+    gint64  synced_us;     /* compositor caught up with the unmap */
+    gboolean click_pending;
+    guint   click_timeout;
+    gulong  paint_handler;
 } State;
 
 /* ------------------------------------------------------------------ */
 /*  hyprctl — direct socket                                            */
 /* ------------------------------------------------------------------ */
 
-static char *hyprctl_request(const char *request) {
-    const char *his = getenv("HYPRLAND_INSTANCE_SIGNATURE");
-    if (!his) return NULL;
-
-    char path[256];
-    snprintf(path, sizeof(path), "/tmp/hypr/%s/.socket.sock", his);
-
-    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (fd < 0) return NULL;
+/* directory holding hyprland's sockets, resolved on first use.
+ * older versions put them in /tmp/hypr, newer ones in $XDG_RUNTIME_DIR. */
+static char hypr_dir[256];
 
+static int hypr_try_connect(const char *dir, const char *name) {
     struct sockaddr_un addr = { .sun_family = AF_UNIX };
-    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
-
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/%s", dir, name);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
     if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        const char *xrd = getenv("XDG_RUNTIME_DIR");
-        if (xrd) {
-            snprintf(path, sizeof(path), "%s/hypr/%s/.socket.sock", xrd, his);
-            strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
-            if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-                close(fd);
-                return NULL;
-            }
-        } else {
-            close(fd);
-            return NULL;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* connect to one of hyprland's sockets (".socket.sock" for requests,
+ * ".socket2.sock" for events) */
+static int hypr_connect(const char *name) {
+    if (hypr_dir[0]) {
+        int fd = hypr_try_connect(hypr_dir, name);
+        if (fd >= 0) return fd;
+        hypr_dir[0] = '\0';  /* compositor restarted? resolve again */
+    }
+
+    const char *his = getenv("HYPRLAND_INSTANCE_SIGNATURE");
+    if (!his) return -1;
+
+    char dirs[2][256];
+    snprintf(dirs[0], sizeof(dirs[0]), "/tmp/hypr/%s", his);
+    const char *xrd = getenv("XDG_RUNTIME_DIR");
+    int ndirs = 1;
+    if (xrd) snprintf(dirs[ndirs++], sizeof(dirs[1]), "%s/hypr/%s", xrd, his);
+
+    for (int i = 0; i < ndirs; i++) {
+        int fd = hypr_try_connect(dirs[i], name);
+        if (fd >= 0) {
+            snprintf(hypr_dir, sizeof(hypr_dir), "%s", dirs[i]);
+            return fd;
         }
     }
+    return -1;
+}
+
+/* hyprland answers one request per connection and then closes it, so
+ * the request socket can't be kept open; only its path is cached.
+ * sending returns the connection to read the reply from, -1 on failure */
+static int hyprctl_send(const char *request) {
+    gint64 t0 = g_get_monotonic_time();
+    stats.hypr_calls++;
+    int fd = hypr_connect(".socket.sock");
+    if (fd < 0) return -1;
 
     size_t rlen = strlen(request);
     if (write(fd, request, rlen) != (ssize_t)rlen) {
         close(fd);
-        return NULL;
+        fd = -1;
     }
+    stats.hypr_us += g_get_monotonic_time() - t0;
+    return fd;
+}
 
+/* read a reply to the end and close its connection */
+static char *hyprctl_reply(int fd) {
+    if (fd < 0) return NULL;
+    gint64 t0 = g_get_monotonic_time();
     size_t cap = 8192, len = 0;
     char *buf = malloc(cap);
     while (1) {
@@ -209,112 +653,255 @@ static char *hyprctl_request(const char *request) {
     }
     buf[len] = '\0';
     close(fd);
+    stats.hypr_us += g_get_monotonic_time() - t0;
     return buf;
 }
 
+static char *hyprctl_request(const char *request) {
+    return hyprctl_reply(hyprctl_send(request));
+}
+
 /* ------------------------------------------------------------------ */
-/*  json helpers                                                       */
+/*  json parsing                                                       */
 /* ------------------------------------------------------------------ */
 
-static int json_int(const char *j, const char *key, int def) {
-    char pat[128];
-    snprintf(pat, sizeof(pat), "\"%s\":", key);
-    const char *p = strstr(j, pat);
-    if (!p) return def;
-    p += strlen(pat);
-    while (*p == ' ' || *p == '\t') p++;
-    return atoi(p);
-}
-
-static char *json_str(const char *j, const char *key, char *buf, size_t sz) {
-    char pat[128];
-    snprintf(pat, sizeof(pat), "\"%s\":", key);
-    const char *p = strstr(j, pat);
-    buf[0] = '\0';
-    if (!p) return buf;
-    p += strlen(pat);
-    while (*p == ' ' || *p == '\t') p++;
-    if (*p != '"') return buf;
-    p++;
-    size_t i = 0;
-    while (*p && *p != '"' && i < sz - 1) {
-        if (*p == '\\' && *(p + 1)) {
-            p++;
-            switch (*p) {
-                case '"': case '\\': case '/': buf[i++] = *p; break;
-                case 'n': buf[i++] = '\n'; break;
-                case 't': buf[i++] = '\t'; break;
-                default:  buf[i++] = *p; break;
+/* a small destructive tokenizer for hyprctl replies: strings are
+ * unescaped in place and NUL-terminated inside the reply buffer, so
+ * the parsed tables just point into it. values we don't care about are
+ * skipped without looking at them twice. */
+
+static void jp_ws(char **p) {
+    while (**p == ' ' || **p == '\t' || **p == '\n' || **p == '\r') (*p)++;
+}
+
+static void jp_utf8(char **out, unsigned cp) {
+    char *o = *out;
+    if (cp < 0x80) *o++ = cp;
+    else if (cp < 0x800) { *o++ = 0xc0 | cp >> 6; *o++ = 0x80 | (cp & 0x3f); }
+    else if (cp < 0x10000) {
+        *o++ = 0xe0 | cp >> 12;
+        *o++ = 0x80 | (cp >> 6 & 0x3f);
+        *o++ = 0x80 | (cp & 0x3f);
+    } else {
+        *o++ = 0xf0 | cp >> 18;
+        *o++ = 0x80 | (cp >> 12 & 0x3f);
+        *o++ = 0x80 | (cp >> 6 & 0x3f);
+        *o++ = 0x80 | (cp & 0x3f);
+    }
+    *out = o;
+}
+
+static unsigned jp_hex4(const char *p) {
+    unsigned v = 0;
+    for (int i = 0; i < 4; i++) {
+        int d = g_ascii_xdigit_value(p[i]);
+        if (d < 0) return 0xfffd;
+        v = v << 4 | d;
+    }
+    return v;
+}
+
+static void jp_skip(char **p);
+
+/* *p is at the opening quote. returns the unescaped string (in place),
+ * or "" after skipping the value if it isn't a string */
+static char *jp_str(char **p) {
+    if (**p != '"') { jp_skip(p); return ""; }
+    char *s = ++*p, *o = s;
+    while (**p && **p != '"') {
+        if (**p != '\\' || !(*p)[1]) { *o++ = *(*p)++; continue; }
+        (*p)++;
+        char e = *(*p)++;
+        switch (e) {
+            case 'n': *o++ = '\n'; break;
+            case 't': *o++ = '\t'; break;
+            case 'r': *o++ = '\r'; break;
+            case 'b': *o++ = '\b'; break;
+            case 'f': *o++ = '\f'; break;
+            case 'u': {
+                if (strlen(*p) < 4) { *p += strlen(*p); break; }
+                unsigned cp = jp_hex4(*p);
+                *p += 4;
+                if (cp >= 0xd800 && cp < 0xdc00 && (*p)[0] == '\\' &&
+                    (*p)[1] == 'u' && strlen(*p) >= 6) {
+                    unsigned lo = jp_hex4(*p + 2);
+                    if (lo >= 0xdc00 && lo < 0xe000) {
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                        *p += 6;
+                    }
+                }
+                jp_utf8(&o, cp);
+                break;
             }
-            p++;
-        } else {
-            buf[i++] = *p++;
+            default: *o++ = e; break;  /* " \ / */
         }
     }
-    buf[i] = '\0';
-    return buf;
+    if (**p) (*p)++;
+    *o = '\0';
+    return s;
+}
+
+static long jp_num(char **p) {
+    char *end;
+    long v = strtol(*p, &end, 10);
+    *p = end;
+    /* drop any fraction/exponent */
+    while (**p == '.' || **p == 'e' || **p == 'E' || **p == '+' ||
+           **p == '-' || g_ascii_isdigit(**p))
+        (*p)++;
+    return v;
+}
+
+static gboolean jp_bool(char **p) {
+    gboolean v = strncmp(*p, "true", 4) == 0;
+    while (g_ascii_isalpha(**p)) (*p)++;
+    return v;
+}
+
+/* skip one value of any type */
+static void jp_skip(char **p) {
+    int depth = 0;
+    do {
+        jp_ws(p);
+        switch (**p) {
+            case '\0': return;
+            case '"':  jp_str(p); break;
+            case '{': case '[': depth++; (*p)++; break;
+            case '}': case ']': depth--; (*p)++; break;
+            case ',': case ':': (*p)++; break;
+            default: {
+                char *at = *p;
+                if (g_ascii_isalpha(**p)) jp_bool(p);
+                else jp_num(p);
+                if (*p == at) (*p)++;  /* not json, step over it */
+                break;
+            }
+        }
+    } while (depth > 0);
+}
+
+/* step to the next member of the object *p is in (or at the '{' of).
+ * returns FALSE after the closing '}' or on garbage. */
+static gboolean jp_member(char **p, char **key) {
+    jp_ws(p);
+    if (**p == '{' || **p == ',') (*p)++;
+    jp_ws(p);
+    if (**p != '"') {
+        if (**p == '}') (*p)++;
+        return FALSE;
+    }
+    *key = jp_str(p);
+    jp_ws(p);
+    if (**p != ':') return FALSE;
+    (*p)++;
+    jp_ws(p);
+    return TRUE;
+}
+
+/* same for arrays: TRUE when *p is at the next element */
+static gboolean jp_elem(char **p) {
+    jp_ws(p);
+    if (**p == '[' || **p == ',') (*p)++;
+    jp_ws(p);
+    if (**p == ']') { (*p)++; return FALSE; }
+    return **p != '\0';
 }
 
-static void json_int_pair(const char *j, const char *key, int *a, int *b) {
-    char pat[128];
-    snprintf(pat, sizeof(pat), "\"%s\":", key);
-    const char *p = strstr(j, pat);
-    if (!p) { *a = 0; *b = 0; return; }
-    p += strlen(pat);
-    while (*p && *p != '[') p++;
-    if (*p == '[') p++;
-    *a = atoi(p);
-    while (*p && *p != ',') p++;
-    if (*p == ',') p++;
-    *b = atoi(p);
+/* [a, b] */
+static void jp_pair(char **p, int *a, int *b) {
+    *a = *b = 0;
+    if (jp_elem(p)) *a = jp_num(p);
+    if (jp_elem(p)) *b = jp_num(p);
+    while (jp_elem(p)) jp_skip(p);
 }
 
 /* ------------------------------------------------------------------ */
-/*  hyprctl client geometry lookup                                     */
+/*  hyprland clients and monitors                                      */
 /* ------------------------------------------------------------------ */
 
-/* find the matching '}' for a '{', handling nested braces */
-static const char *find_block_end(const char *p) {
-    int depth = 0;
-    gboolean in_str = FALSE;
-    for (; *p; p++) {
-        if (*p == '\\' && in_str) { p++; continue; }
-        if (*p == '"') { in_str = !in_str; continue; }
-        if (in_str) continue;
-        if (*p == '{') depth++;
-        else if (*p == '}') { depth--; if (depth == 0) return p; }
+typedef struct {
+    const char *address;
+    const char *title;
+    const char *cls;
+    int  pid;
+    int  x, y, w, h;
+    int  workspace;
+    int  monitor;
+    gboolean mapped, hidden;
+} HyprClient;
+
+/* the parsed j/clients reply. strings point into buf */
+typedef struct {
+    char       *buf;
+    HyprClient *c;
+    int         n, cap;
+    GHashTable *by_pid;   /* pid -> index + 1 of its first client */
+} HyprClients;
+
+static void hypr_client_parse(char **p, HyprClient *hc) {
+    memset(hc, 0, sizeof(*hc));
+    hc->address = hc->title = hc->cls = "";
+    hc->pid = -1;
+    hc->mapped = TRUE;
+    char *key;
+    while (jp_member(p, &key)) {
+        if (strcmp(key, "pid") == 0) hc->pid = jp_num(p);
+        else if (strcmp(key, "title") == 0) hc->title = jp_str(p);
+        else if (strcmp(key, "class") == 0) hc->cls = jp_str(p);
+        else if (strcmp(key, "address") == 0) hc->address = jp_str(p);
+        else if (strcmp(key, "at") == 0) jp_pair(p, &hc->x, &hc->y);
+        else if (strcmp(key, "size") == 0) jp_pair(p, &hc->w, &hc->h);
+        else if (strcmp(key, "monitor") == 0) hc->monitor = jp_num(p);
+        else if (strcmp(key, "mapped") == 0) hc->mapped = jp_bool(p);
+        else if (strcmp(key, "hidden") == 0) hc->hidden = jp_bool(p);
+        else if (strcmp(key, "workspace") == 0 && **p == '{') {
+            char *wkey;
+            while (jp_member(p, &wkey)) {
+                if (strcmp(wkey, "id") == 0) hc->workspace = jp_num(p);
+                else jp_skip(p);
+            }
+        } else {
+            jp_skip(p);
+        }
     }
-    return NULL;
 }
 
-/* find the geometry of a hyprland client by matching its pid against
- * the clients json array. returns false if not found. */
-static gboolean find_client_geom(const char *clients_json, int pid,
-                                  int *cx, int *cy, int *cw, int *ch)
-{
-    if (!clients_json || pid <= 0) return FALSE;
-
-    const char *p = clients_json;
-    while ((p = strchr(p, '{')) != NULL) {
-        const char *end = find_block_end(p);
-        if (!end) break;
-
-        size_t blen = end - p + 1;
-        char *block = malloc(blen + 1);
-        memcpy(block, p, blen);
-        block[blen] = '\0';
-
-        int cpid = json_int(block, "pid", -1);
-        if (cpid == pid) {
-            json_int_pair(block, "at", cx, cy);
-            json_int_pair(block, "size", cw, ch);
-            free(block);
-            return TRUE;
+/* parse a j/clients reply, taking ownership of json */
+static void hypr_clients_parse(HyprClients *hc, char *json) {
+    memset(hc, 0, sizeof(*hc));
+    hc->buf = json;
+    hc->by_pid = g_hash_table_new(g_direct_hash, g_direct_equal);
+    if (!json) return;
+
+    char *p = json;
+    jp_ws(&p);
+    if (*p != '[') return;
+    while (jp_elem(&p)) {
+        if (*p != '{') { jp_skip(&p); continue; }
+        if (hc->n == hc->cap) {
+            hc->cap = hc->cap ? hc->cap * 2 : 32;
+            hc->c = g_renew(HyprClient, hc->c, hc->cap);
         }
-        free(block);
-        p = end + 1;
+        HyprClient *c = &hc->c[hc->n];
+        hypr_client_parse(&p, c);
+        gpointer key = GINT_TO_POINTER(c->pid);
+        if (c->pid > 0 && !g_hash_table_contains(hc->by_pid, key))
+            g_hash_table_insert(hc->by_pid, key, GINT_TO_POINTER(hc->n + 1));
+        hc->n++;
     }
-    return FALSE;
+}
+
+static void hypr_clients_free(HyprClients *hc) {
+    free(hc->buf);
+    g_free(hc->c);
+    if (hc->by_pid) g_hash_table_destroy(hc->by_pid);
+    memset(hc, 0, sizeof(*hc));
+}
+
+static const HyprClient *hypr_client_by_pid(const HyprClients *hc, int pid) {
+    if (!hc->by_pid || pid <= 0) return NULL;
+    int i = GPOINTER_TO_INT(g_hash_table_lookup(hc->by_pid, GINT_TO_POINTER(pid)));
+    return i ? &hc->c[i - 1] : NULL;
 }
 
 /* check if two titles share a long enough common substring to be
@@ -334,296 +921,2925 @@ static gboolean titles_match(const char *a, const char *b) {
     return FALSE;
 }
 
-/* find client geometry by matching AT-SPI window title against
+/* find a client by matching an AT-SPI window title against
  * hyprctl client titles */
-static gboolean find_client_geom_by_title(const char *clients_json,
-                                            const char *title,
-                                            int *cx, int *cy, int *cw, int *ch)
+static const HyprClient *hypr_client_by_title(const HyprClients *hc,
+                                              const char *title)
 {
-    if (!clients_json || !title || !title[0]) return FALSE;
-
-    const char *p = clients_json;
-    while ((p = strchr(p, '{')) != NULL) {
-        const char *end = find_block_end(p);
-        if (!end) break;
+    if (!title || !title[0]) return NULL;
+    for (int i = 0; i < hc->n; i++)
+        if (titles_match(hc->c[i].title, title)) return &hc->c[i];
+    return NULL;
+}
 
-        size_t blen = end - p + 1;
-        char *block = malloc(blen + 1);
-        memcpy(block, p, blen);
-        block[blen] = '\0';
+/* ------------------------------------------------------------------ */
+/*  hyprland state — kept live from the event socket in the daemon     */
+/* ------------------------------------------------------------------ */
 
-        char ctitle[256];
-        json_str(block, "title", ctitle, sizeof(ctitle));
+/* the daemon subscribes to .socket2.sock and refetches clients or
+ * monitors shortly after an event that can change them, so clicking
+ * and pre-walks read memory instead of waiting on IPC. splits, resizes
+ * and floating drags send no event though, so a trigger still asks for
+ * the client table: the request goes out first thing and its reply is
+ * read when the table is first needed. without a subscription (one-shot
+ * runs, or the socket went away) everything is fetched on demand, once
+ * per collection. */
+static struct {
+    HyprClients clients;
+    gboolean    clients_stale;
+    int         clients_fd;     /* j/clients sent, reply not read yet, or -1 */
+    int         screen_w, screen_h;
+    gboolean    monitors_stale;
+    char        active[32];     /* address of the focused client, "" = unknown */
+    char       *active_json;    /* j/activewindow reply backing active_client */
+    HyprClient  active_client;
+    int         events_fd;      /* -1 when not subscribed */
+    GString    *events_buf;
+    guint       refresh_id;
+} hypr = {
+    .clients_stale = TRUE, .monitors_stale = TRUE, .events_fd = -1, .clients_fd = -1,
+};
 
-        if (titles_match(ctitle, title)) {
-            json_int_pair(block, "at", cx, cy);
-            json_int_pair(block, "size", cw, ch);
-            free(block);
-            return TRUE;
-        }
-        free(block);
-        p = end + 1;
-    }
-    return FALSE;
+static gboolean hypr_live(void) {
+    return hypr.events_fd >= 0;
 }
 
-/* ------------------------------------------------------------------ */
-/*  label generation                                                   */
-/* ------------------------------------------------------------------ */
+static void hypr_fetch_monitors(void) {
+    char *json = hyprctl_request("j/monitors");
+    hypr.screen_w = 1920;
+    hypr.screen_h = 1080;
+    hypr.monitors_stale = FALSE;
+    if (!json) return;
 
-static void generate_labels(Target *t, int n) {
-    if (n <= 26) {
-        for (int i = 0; i < n; i++) {
-            t[i].label[0] = 'a' + i;
-            t[i].label[1] = '\0';
-        }
-        return;
-    }
-    int len = 1, p = 26;
-    while (p < n) { len++; p *= 26; }
-    for (int i = 0; i < n; i++) {
-        int v = i;
-        for (int j = len - 1; j >= 0; j--) {
-            t[i].label[j] = 'a' + (v % 26);
-            v /= 26;
+    int max_x = 0, max_y = 0;
+    char *p = json;
+    jp_ws(&p);
+    if (*p == '[') {
+        while (jp_elem(&p)) {
+            int mx = 0, my = 0, mw = 0, mh = 0;
+            char *key;
+            if (*p != '{') { jp_skip(&p); continue; }
+            while (jp_member(&p, &key)) {
+                if (strcmp(key, "x") == 0) mx = jp_num(&p);
+                else if (strcmp(key, "y") == 0) my = jp_num(&p);
+                else if (strcmp(key, "width") == 0) mw = jp_num(&p);
+                else if (strcmp(key, "height") == 0) mh = jp_num(&p);
+                else jp_skip(&p);
+            }
+            if (mx + mw > max_x) max_x = mx + mw;
+            if (my + mh > max_y) max_y = my + mh;
         }
-        t[i].label[len] = '\0';
     }
-}
+    free(json);
 
-/* ------------------------------------------------------------------ */
-/*  at-spi tree walk                                                   */
-/* ------------------------------------------------------------------ */
+    if (max_x > 0) hypr.screen_w = max_x;
+    if (max_y > 0) hypr.screen_h = max_y;
+}
 
-/* check if a target overlaps an existing one (nearly identical position) */
-static gboolean is_duplicate(Target *out, int n, int x, int y) {
-    for (int i = n - 1; i >= 0 && i >= n - 10; i--) {
-        int dx = abs(out[i].x - x);
-        int dy = abs(out[i].y - y);
-        if (dx <= 4 && dy <= 4) return TRUE;
+/* the current client table */
+static const HyprClients *hypr_clients(void) {
+    if (hypr.clients_stale || hypr.clients_fd >= 0) {
+        hypr_clients_free(&hypr.clients);
+        hypr_clients_parse(&hypr.clients, hypr.clients_fd >= 0 ? hyprctl_reply(hypr.clients_fd)
+                                                               : hyprctl_request("j/clients"));
+        hypr.clients_fd = -1;
+        hypr.clients_stale = FALSE;
     }
-    return FALSE;
+    return &hypr.clients;
 }
 
-static void walk(AtspiAccessible *node, Target *out, int *n, int depth) {
-    if (!node || depth > 30 || *n >= MAX_TARGETS) return;
+/* the total screen bounding box over all monitors */
+static void hypr_screen_bounds(int *w, int *h) {
+    if (hypr.monitors_stale) hypr_fetch_monitors();
+    *w = hypr.screen_w;
+    *h = hypr.screen_h;
+}
 
-    GError *err = NULL;
-    AtspiRole role = atspi_accessible_get_role(node, &err);
-    if (err) { g_error_free(err); goto kids; }
+/* the focused client, or NULL */
+static const HyprClient *hypr_active(void) {
+    if (hypr_live() && hypr.active[0]) {
+        const HyprClients *hc = hypr_clients();
+        for (int i = 0; i < hc->n; i++)
+            if (strcmp(hc->c[i].address, hypr.active) == 0) return &hc->c[i];
+    }
 
-    if (depth > 0) {
-        AtspiStateSet *ss = atspi_accessible_get_state_set(node);
-        if (ss) {
-            gboolean ok = atspi_state_set_contains(ss, ATSPI_STATE_VISIBLE)
-                       && atspi_state_set_contains(ss, ATSPI_STATE_SHOWING);
-            g_object_unref(ss);
-            if (!ok) return;
-        }
+    free(hypr.active_json);
+    hypr.active_json = hyprctl_request("j/activewindow");
+    if (!hypr.active_json) return NULL;
+    char *p = hypr.active_json;
+    jp_ws(&p);
+    if (*p != '{') return NULL;
+    hypr_client_parse(&p, &hypr.active_client);
+    return &hypr.active_client;
+}
+
+/* pointer position in layout coordinates. hyprland doesn't report
+ * pointer motion on the event socket, so this is always a request. */
+static gboolean hypr_cursor(int *x, int *y) {
+    char *json = hyprctl_request("j/cursorpos");
+    if (!json) return FALSE;
+    gboolean got_x = FALSE, got_y = FALSE;
+    char *p = json, *key;
+    jp_ws(&p);
+    if (*p == '{') while (jp_member(&p, &key)) {
+        if (strcmp(key, "x") == 0) { *x = jp_num(&p); got_x = TRUE; }
+        else if (strcmp(key, "y") == 0) { *y = jp_num(&p); got_y = TRUE; }
+        else jp_skip(&p);
     }
+    free(json);
+    return got_x && got_y;
+}
 
-    if ((int)role < 256 && clickable_lut[(int)role]) {
-        AtspiComponent *comp = atspi_accessible_get_component_iface(node);
-        if (comp) {
-            AtspiRect *ext = atspi_component_get_extents(
-                comp, ATSPI_COORD_TYPE_SCREEN, &err);
-            if (ext && !err) {
-                if (ext->width > 0 && ext->height > 0 &&
-                    !is_duplicate(out, *n, ext->x, ext->y)) {
-                    Target *t = &out[*n];
-                    t->x = ext->x; t->y = ext->y;
-                    t->w = ext->width; t->h = ext->height;
-                    gchar *nm = atspi_accessible_get_name(node, NULL);
-                    if (nm) {
-                        strncpy(t->name, nm, sizeof(t->name) - 1);
-                        t->name[sizeof(t->name) - 1] = '\0';
-                        g_free(nm);
-                    } else {
-                        t->name[0] = '\0';
-                    }
-                    (*n)++;
-                }
-            }
-            if (ext) g_free(ext);
-            if (err) g_error_free(err);
-            g_object_unref(comp);
-        }
+/* a collection starts: forget everything fetched without a
+ * subscription, and with one, send for the client table anyway, since
+ * window geometry can change without an event */
+static void hypr_begin(void) {
+    if (!hypr_live()) {
+        hypr.clients_stale = TRUE;
+        hypr.monitors_stale = TRUE;
+        return;
     }
+    if (hypr.clients_fd < 0) hypr.clients_fd = hyprctl_send("j/clients");
+    if (hypr.clients_fd < 0) hypr.clients_stale = TRUE;
+}
 
-kids:;
-    int nc = atspi_accessible_get_child_count(node, NULL);
-    for (int i = 0; i < nc && *n < MAX_TARGETS; i++) {
-        AtspiAccessible *ch = atspi_accessible_get_child_at_index(node, i, NULL);
-        if (ch) { walk(ch, out, n, depth + 1); g_object_unref(ch); }
+static void pointer_open(void);
+
+static gboolean hypr_refresh_cb(gpointer data) {
+    (void)data;
+    hypr.refresh_id = 0;
+    if (hypr.clients_stale) hypr_clients();
+    if (hypr.monitors_stale) {
+        hypr_fetch_monitors();
+        pointer_open();  /* resize the pointer's axes ahead of the next click */
     }
+    return G_SOURCE_REMOVE;
 }
 
-/* walk all AT-SPI apps/windows, collecting targets from every one.
- * for windows with broken coords (GTK4), use grid_fallback per window. */
-static void collect_all_targets(State *st, const char *clients_json) {
-    AtspiAccessible *desktop = atspi_get_desktop(0);
-    int napps = atspi_accessible_get_child_count(desktop, NULL);
+/* coalesce a burst of events (a workspace switch moves every window)
+ * into a single refetch */
+static void hypr_schedule_refresh(void) {
+    if (!hypr.refresh_id)
+        hypr.refresh_id = g_timeout_add(20, hypr_refresh_cb, NULL);
+}
 
-    for (int i = 0; i < napps && st->n_targets < MAX_TARGETS; i++) {
-        AtspiAccessible *app = atspi_accessible_get_child_at_index(desktop, i, NULL);
-        if (!app) continue;
-
-        int nwins = atspi_accessible_get_child_count(app, NULL);
-        guint app_pid = atspi_accessible_get_process_id(app, NULL);
-
-        for (int k = 0; k < nwins && st->n_targets < MAX_TARGETS; k++) {
-            AtspiAccessible *w = atspi_accessible_get_child_at_index(app, k, NULL);
-            if (!w) continue;
-
-            /* remember where this window's targets start */
-            int start = st->n_targets;
-
-            walk(w, st->targets, &st->n_targets, 0);
-
-            int count = st->n_targets - start;
-            if (count > 0) {
-                /* look up this window's actual geometry from hyprctl */
-                int wx = 0, wy = 0, ww = 0, wh = 0;
-                gboolean found = find_client_geom(clients_json,
-                                                   (int)app_pid,
-                                                   &wx, &wy, &ww, &wh);
-                if (!found) {
-                    gchar *wtitle = atspi_accessible_get_name(w, NULL);
-                    if (wtitle) {
-                        found = find_client_geom_by_title(clients_json,
-                                    wtitle, &wx, &wy, &ww, &wh);
-                        g_free(wtitle);
-                    }
-                }
+static void prewalk_schedule(void);
 
-                gchar *dbg_name = atspi_accessible_get_name(w, NULL);
-                fprintf(stderr, "[wlim] window \"%s\": %d targets, geom found=%d at=(%d,%d) size=(%d,%d) pid_atspi=%d\n",
-                        dbg_name ? dbg_name : "?", count, found, wx, wy, ww, wh, (int)app_pid);
-                if (dbg_name) g_free(dbg_name);
-
-                /* check if this window's coords are usable */
-                int zeros = 0;
-                for (int t = start; t < st->n_targets; t++)
-                    if (st->targets[t].x == 0 && st->targets[t].y == 0) zeros++;
-
-                if ((double)zeros / count >= 0.8) {
-                    /* broken coords (GTK4) — distribute in a grid */
-                    if (found && ww > 0 && wh > 0) {
-                        int m = 30;
-                        int gx = wx + m, gy = wy + m;
-                        int gw = ww - m*2, gh = wh - m*2;
-                        int cols = (int)ceil(sqrt((double)count));
-                        int rows = (int)ceil((double)count / cols);
-                        double cw = (double)gw / (cols ? cols : 1);
-                        double ch = (double)gh / (rows ? rows : 1);
-                        for (int t = 0; t < count; t++) {
-                            int px = (int)(gx + (t % cols) * cw + cw / 2);
-                            int py = (int)(gy + (t / cols) * ch + ch / 2);
-                            st->targets[start + t].lx = px;
-                            st->targets[start + t].ly = py;
-                            st->targets[start + t].cx = px;
-                            st->targets[start + t].cy = py;
-                        }
-                    } else {
-                        st->n_targets = start;
-                    }
-                } else {
-                    /* coords are present — check if they're window-relative.
-                     * on wayland, some apps (chromium) report AT-SPI coords
-                     * relative to the window instead of the screen. detect
-                     * this by checking if all coords fall within [0, ww) x
-                     * [0, wh) rather than [wx, wx+ww) x [wy, wy+wh). */
-                    int off_x = 0, off_y = 0;
-                    if (found && ww > 0 && wh > 0 && (wx > 0 || wy > 0)) {
-                        int window_rel = 0;
-                        for (int t = start; t < st->n_targets; t++) {
-                            Target *tg = &st->targets[t];
-                            if (tg->x >= 0 && tg->x < ww &&
-                                tg->y >= 0 && tg->y < wh)
-                                window_rel++;
-                        }
-                        /* if most coords fit inside [0,ww)x[0,wh) but the
-                         * window isn't at (0,0), they're window-relative */
-                        fprintf(stderr, "[wlim]   window_rel=%d/%d (%.0f%%)\n",
-                                window_rel, count, 100.0 * window_rel / count);
-                        if ((double)window_rel / count >= 0.8) {
-                            off_x = wx;
-                            off_y = wy;
-                            fprintf(stderr, "[wlim]   applying offset (%d,%d)\n", off_x, off_y);
-                        }
-                    }
+static void hypr_event(const char *name, const char *data) {
+    if (strcmp(name, "activewindowv2") == 0) {
+        /* events carry bare hex addresses, j/clients has 0x... */
+        if (!data[0]) hypr.active[0] = '\0';
+        else snprintf(hypr.active, sizeof(hypr.active), "%s%s",
+                      strncmp(data, "0x", 2) == 0 ? "" : "0x", data);
+        if (data[0]) prewalk_schedule();
+        return;
+    }
 
-                    for (int t = start; t < st->n_targets; t++) {
-                        Target *tg = &st->targets[t];
-                        tg->cx = tg->x + off_x + tg->w / 2;
-                        tg->cy = tg->y + off_y + tg->h / 2;
-                        tg->lx = tg->x + off_x + 16;
-                        tg->ly = tg->y + off_y + 8;
-                    }
-                }
-            }
+    /* there's no event for a split, a resize or a floating drag, so this
+     * only keeps the table warm between triggers; hypr_begin refetches */
+    static const char *const client_events[] = {
+        "openwindow", "closewindow", "movewindow", "movewindowv2",
+        "changefloatingmode", "fullscreen", "workspace",
+        "workspacev2", "moveworkspace", "moveworkspacev2", "activewindow",
+        "windowtitle", "windowtitlev2", "pin", "minimized", NULL,
+    };
+    static const char *const monitor_events[] = {
+        "monitoradded", "monitoraddedv2", "monitorremoved",
+        "monitorremovedv2", NULL,
+    };
 
-            g_object_unref(w);
+    for (int i = 0; monitor_events[i]; i++)
+        if (strcmp(name, monitor_events[i]) == 0) {
+            hypr.monitors_stale = TRUE;
+            hypr.clients_stale = TRUE;
+            hypr_schedule_refresh();
+            return;
+        }
+    for (int i = 0; client_events[i]; i++)
+        if (strcmp(name, client_events[i]) == 0) {
+            hypr.clients_stale = TRUE;
+            hypr_schedule_refresh();
+            return;
+        }
+}
+
+static gboolean on_hypr_events(int fd, GIOCondition cond, gpointer data) {
+    (void)cond; (void)data;
+    char buf[4096];
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n <= 0) {
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) return G_SOURCE_CONTINUE;
+        fprintf(stderr, "[wlim] hyprland event socket closed, querying on demand\n");
+        close(fd);
+        hypr.events_fd = -1;
+        hypr.clients_stale = TRUE;
+        hypr.monitors_stale = TRUE;
+        return G_SOURCE_REMOVE;
+    }
+
+    /* lines look like "openwindow>>80e62df0,2,foot,~" */
+    g_string_append_len(hypr.events_buf, buf, n);
+    char *line = hypr.events_buf->str, *nl;
+    while ((nl = strchr(line, '\n'))) {
+        *nl = '\0';
+        char *sep = strstr(line, ">>");
+        if (sep) {
+            *sep = '\0';
+            hypr_event(line, sep + 2);
         }
-        g_object_unref(app);
+        line = nl + 1;
+    }
+    g_string_erase(hypr.events_buf, 0, line - hypr.events_buf->str);
+    return G_SOURCE_CONTINUE;
+}
+
+/* daemon: subscribe to hyprland's event socket and warm the tables */
+static void hypr_subscribe(void) {
+    int fd = hypr_connect(".socket2.sock");
+    if (fd < 0) {
+        fprintf(stderr, "[wlim] no hyprland event socket, querying on demand\n");
+        return;
     }
+    hypr.events_fd = fd;
+    hypr.events_buf = g_string_new(NULL);
+    g_unix_fd_add(fd, G_IO_IN | G_IO_HUP | G_IO_ERR, on_hypr_events, NULL);
+    hypr_clients();
+    hypr_fetch_monitors();
 }
 
 /* ------------------------------------------------------------------ */
-/*  uinput — direct virtual input device                               */
+/*  click history                                                      */
 /* ------------------------------------------------------------------ */
 
-/* get the total screen bounding box from hyprctl monitors.
- * for multi-monitor setups this returns the combined extent. */
-static void get_screen_bounds(int *total_w, int *total_h) {
-    char *json = hyprctl_request("j/monitors");
-    *total_w = 1920;
-    *total_h = 1080;
-    if (!json) return;
-
-    int max_x = 0, max_y = 0;
-    const char *p = json;
-    while ((p = strchr(p, '{')) != NULL) {
-        const char *end = find_block_end(p);
-        if (!end) break;
+/* every click bumps a decaying counter for what was clicked, keyed by a
+ * hash of the app's class, the element's role and its name, so "Send"
+ * in a mail client is remembered across windows and restarts. the
+ * counters sit in a fixed-size open-addressed table that is mmap()ed
+ * straight from $XDG_STATE_HOME/wlim/history: loading it is one mmap,
+ * and noting a click is a store into shared memory that the kernel
+ * writes back. a key only ever probes HISTORY_PROBE slots; once those
+ * are all taken, the weakest of them makes way. */
 
-        size_t blen = end - p + 1;
-        char *block = malloc(blen + 1);
-        memcpy(block, p, blen);
-        block[blen] = '\0';
+#define HISTORY_MAGIC  "wlimhis1"
+#define HISTORY_SLOTS  8192
+#define HISTORY_PROBE  16
 
-        int mx = json_int(block, "x", 0);
-        int my = json_int(block, "y", 0);
-        int mw = json_int(block, "width", 0);
-        int mh = json_int(block, "height", 0);
+typedef struct {
+    guint32 key;      /* 0 = empty */
+    float   count;    /* as of stamp */
+    guint32 stamp;    /* minutes since the epoch */
+} HistSlot;
 
-        if (mx + mw > max_x) max_x = mx + mw;
-        if (my + mh > max_y) max_y = my + mh;
+typedef struct {
+    char     magic[8];
+    guint32  nslots;
+    guint32  reserved;
+    HistSlot slot[];
+} HistFile;
 
-        free(block);
-        p = end + 1;
-    }
-    free(json);
+static HistFile *history;
 
-    if (max_x > 0) *total_w = max_x;
-    if (max_y > 0) *total_h = max_y;
+static guint32 history_now(void) {
+    return (guint32)(g_get_real_time() / (60 * (gint64)G_USEC_PER_SEC));
 }
 
-static void emit(int fd, int type, int code, int val) {
-    struct input_event ev = {0};
-    ev.type = type;
-    ev.code = code;
-    ev.value = val;
-    write(fd, &ev, sizeof(ev));
+static double history_decayed(const HistSlot *e, guint32 now) {
+    double age = now > e->stamp ? now - e->stamp : 0;
+    return e->count * exp2(-age / (cfg.history_half_life * 24.0 * 60.0));
 }
 
-static void do_click(int x, int y, int button) {
-    int sw, sh;
-    get_screen_bounds(&sw, &sh);
+static void history_open(void) {
+    if (history || cfg.history_half_life <= 0) return;
 
-    int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    const char *xdg = getenv("XDG_STATE_HOME");
+    const char *home = getenv("HOME");
+    char dir[512], path[560];
+    if (xdg && xdg[0])
+        snprintf(dir, sizeof(dir), "%s/wlim", xdg);
+    else if (home)
+        snprintf(dir, sizeof(dir), "%s/.local/state/wlim", home);
+    else
+        return;
+    g_mkdir_with_parents(dir, 0700);
+    snprintf(path, sizeof(path), "%s/history", dir);
+
+    size_t size = sizeof(HistFile) + HISTORY_SLOTS * sizeof(HistSlot);
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
     if (fd < 0) {
-        fprintf(stderr, "[wlim] cannot open /dev/uinput: %s\n", strerror(errno));
+        fprintf(stderr, "[wlim] cannot open %s: %s\n", path, strerror(errno));
+        return;
+    }
+    struct stat sb;
+    gboolean fresh = fstat(fd, &sb) < 0 || (size_t)sb.st_size != size;
+    if (fresh && (ftruncate(fd, 0) < 0 || ftruncate(fd, size) < 0)) {
+        fprintf(stderr, "[wlim] cannot size %s: %s\n", path, strerror(errno));
+        close(fd);
+        return;
+    }
+    void *m = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        fprintf(stderr, "[wlim] cannot map %s: %s\n", path, strerror(errno));
+        return;
+    }
+
+    history = m;
+    if (memcmp(history->magic, HISTORY_MAGIC, 8) != 0 ||
+        history->nslots != HISTORY_SLOTS) {
+        memset(history, 0, size);
+        memcpy(history->magic, HISTORY_MAGIC, 8);
+        history->nslots = HISTORY_SLOTS;
+    }
+}
+
+/* fnv-1a over class, role and name. unnamed elements get no key, they
+ * can't be told apart from their neighbours */
+static guint32 history_key(const char *cls, int role, const char *name) {
+    if (!name[0]) return 0;
+    guint32 h = 2166136261u;
+    for (const char *p = cls; *p; p++) h = (h ^ (guchar)*p) * 16777619u;
+    h = (h ^ 0x100u) * 16777619u;
+    h = (h ^ (guint32)role) * 16777619u;
+    for (const char *p = name; *p; p++) h = (h ^ (guchar)*p) * 16777619u;
+    return h ? h : 1;
+}
+
+static HistSlot *history_slot(guint32 key, int i) {
+    return &history->slot[(key + i) & (HISTORY_SLOTS - 1)];
+}
+
+/* decayed click count for key, 0 if never clicked */
+static double history_weight(guint32 key) {
+    if (!history || !key) return 0;
+    for (int i = 0; i < HISTORY_PROBE; i++) {
+        const HistSlot *e = history_slot(key, i);
+        if (e->key == key) return history_decayed(e, history_now());
+        if (!e->key) break;
+    }
+    return 0;
+}
+
+static void history_note(guint32 key) {
+    if (!history || !key) return;
+    guint32 now = history_now();
+    HistSlot *e = NULL;
+    double weakest = 0;
+    for (int i = 0; i < HISTORY_PROBE; i++) {
+        HistSlot *c = history_slot(key, i);
+        if (c->key == key || !c->key) { e = c; break; }
+        double d = history_decayed(c, now);
+        if (!e || d < weakest) { e = c; weakest = d; }
+    }
+    if (e->key != key) {
+        e->key = key;
+        e->count = 0;
+    }
+    e->count = (float)(history_decayed(e, now) + 1.0);
+    e->stamp = now;
+}
+
+/* key every target of ts for the history, under its app's class */
+static void history_stamp(TargetStore *ts, const char *cls) {
+    if (!history) return;
+    for (int i = 0; i < ts->n; i++)
+        ts->t[i].hkey = history_key(cls, ts->t[i].role, ts_name(ts, i));
+}
+
+/* ------------------------------------------------------------------ */
+/*  label generation                                                   */
+/* ------------------------------------------------------------------ */
+
+/* the hint alphabet, parsed from cfg.hint_chars. a label is a string
+ * of digits 0..radix-1 written with chars[]. after digit p the digits
+ * are handed out in the order next[p + 1] (next[0] for the first key),
+ * which puts keys typed by the same finger as p last, so the common
+ * labels don't make one finger hit two keys in a row. */
+static struct {
+    char     chars[64];
+    int      radix;
+    int      finger[64];     /* 0..7 from the left pinky, -1 = unknown */
+    guint8   next[65][64];
+    gboolean key[256];       /* chars on_key() accepts */
+} hint;
+
+/* which finger types c, from the column of its key. with a display the
+ * key is looked up in the active layout (so dvorak/colemak work out),
+ * otherwise c is assumed to sit where it does on qwerty. */
+static int key_finger(GdkDisplay *dpy, char c) {
+    static const int col_finger[] = { 0, 1, 2, 3, 3, 4, 4, 5, 6, 7, 7, 7 };
+    static const struct { int first, last; const char *qwerty; } rows[] = {
+        { KEY_1, KEY_EQUAL,      "1234567890-=" },
+        { KEY_Q, KEY_RIGHTBRACE, "qwertyuiop[]" },
+        { KEY_A, KEY_APOSTROPHE, "asdfghjkl;'"  },
+        { KEY_Z, KEY_SLASH,      "zxcvbnm,./"   },
+    };
+    int col = -1;
+
+    GdkKeymapKey *keys = NULL;
+    int nkeys = 0;
+    if (dpy && gdk_display_map_keyval(dpy, gdk_unicode_to_keyval((guchar)c), &keys, &nkeys)) {
+        for (int k = 0; k < nkeys && col < 0; k++) {
+            if (keys[k].level != 0) continue;
+            int code = (int)keys[k].keycode - 8;  /* xkb -> evdev */
+            for (size_t r = 0; r < G_N_ELEMENTS(rows); r++)
+                if (code >= rows[r].first && code <= rows[r].last)
+                    col = code - rows[r].first;
+        }
+        g_free(keys);
+    }
+    for (size_t r = 0; r < G_N_ELEMENTS(rows) && col < 0; r++) {
+        const char *q = strchr(rows[r].qwerty, c);
+        if (q) col = (int)(q - rows[r].qwerty);
+    }
+    return col < 0 ? -1 : col_finger[col];
+}
+
+static int hint_parse(const char *src) {
+    hint.radix = 0;
+    memset(hint.key, 0, sizeof(hint.key));
+    for (const char *p = src; *p && hint.radix < (int)sizeof(hint.chars) - 1; p++) {
+        unsigned char c = (unsigned char)g_ascii_tolower(*p);
+        /* '/' starts search, the rest would need escaping in markup */
+        if (!g_ascii_isgraph(c) || strchr("/<>&\"'", c) || hint.key[c]) continue;
+        hint.key[c] = TRUE;
+        hint.chars[hint.radix++] = (char)c;
+    }
+    hint.chars[hint.radix] = '\0';
+    return hint.radix;
+}
+
+/* a busy desktop has about this many targets; fewer labels than that
+ * and hint_init warns */
+#define HINT_FEW_LABELS 1000
+
+static void hint_init(GdkDisplay *dpy) {
+    if (hint_parse(cfg.hint_chars) < 2) {
+        fprintf(stderr, "[wlim] hint_chars needs at least 2 usable keys, using a-z\n");
+        hint_parse(HINT_CHARS_DEFAULT);
+    }
+    int k = hint.radix;
+    long cap = 1;
+    for (int i = 0; i < MAX_LABEL; i++) cap *= k;
+    if (cap < HINT_FEW_LABELS)
+        fprintf(stderr, "[wlim] hint_chars has only %d keys: at most %ld targets get a hint "
+                "(labels are up to %d keys long)\n", k, cap, MAX_LABEL);
+    for (int i = 0; i < k; i++) {
+        hint.finger[i] = key_finger(dpy, hint.chars[i]);
+        hint.next[0][i] = (guint8)i;
+    }
+    /* after p: other fingers in hint_chars order, then p again, then
+     * the other keys on p's finger */
+    for (int p = 0; p < k; p++) {
+        int n = 0;
+        for (int pass = 0; pass < 3; pass++)
+            for (int i = 0; i < k; i++) {
+                int cost = 0;
+                if (cfg.same_finger == SAME_FINGER_AVOID) {
+                    if (i == p) cost = 1;
+                    else if (hint.finger[i] >= 0 && hint.finger[i] == hint.finger[p]) cost = 2;
+                }
+                if (cost == pass) hint.next[p + 1][n++] = (guint8)i;
+            }
+    }
+}
+
+/* how many fixed-length labels fit below a prefix d keys long */
+static long slot_capacity(int d) {
+    long cap = 1;
+    for (int i = d; i < MAX_LABEL; i++) cap *= hint.radix;
+    return cap;
+}
+
+/* label length needed for n fixed-length hints */
+static int label_len(int n) {
+    int len = 1;
+    for (long p = hint.radix; p < n && len < MAX_LABEL; p *= hint.radix) len++;
+    return len;
+}
+
+/* the digit typed with label char c, -1 for none */
+static int hint_digit(char c) {
+    const char *p = c ? strchr(hint.chars, c) : NULL;
+    return p ? (int)(p - hint.chars) : -1;
+}
+
+/* the i-th of the len-key codes below prefix: i in base radix, each
+ * digit mapped through the key order that follows the one before it */
+static void label_for(const char *prefix, int i, int len, char *out) {
+    int d[MAX_LABEL];
+    for (int j = len - 1; j >= 0; j--) {
+        d[j] = i % hint.radix;
+        i /= hint.radix;
+    }
+    int plen = (int)strlen(prefix);
+    memmove(out, prefix, plen);
+    int prev = plen ? hint_digit(prefix[plen - 1]) : -1;
+    for (int j = 0; j < len; j++) {
+        prev = hint.next[prev + 1][d[j]];
+        out[plen + j] = hint.chars[prev];
+    }
+    out[plen + len] = '\0';
+}
+
+/* the code space labels are handed out from: every label starting with
+ * one of these prefixes is still free. a fresh space is just "". labels
+ * handed out never come back, so a session can keep adding targets
+ * without touching the labels already on screen. */
+typedef struct { char p[MAX_LABEL + 1]; } LabelSlot;
+
+static void label_space_reset(GArray *space) {
+    LabelSlot root = { "" };
+    g_array_set_size(space, 0);
+    g_array_append_val(space, root);
+}
+
+static void label_free(GArray *freed, const char *p) {
+    LabelSlot s;
+    snprintf(s.p, sizeof(s.p), "%s", p);
+    g_array_append_val(freed, s);
+}
+
+/* the len-key codes below prefix from n on are unused: hand them back as
+ * whole subtrees, the first free code itself and, at each key of it, the
+ * keys after it */
+static void label_free_rest(GArray *freed, const char *prefix, int n, int len) {
+    long total = 1;
+    for (int j = 0; j < len; j++) total *= hint.radix;
+    if (n >= total) return;
+
+    char code[MAX_LABEL + 1];
+    label_for(prefix, n, len, code);
+    label_free(freed, code);
+
+    int d[MAX_LABEL];
+    for (int j = len - 1; j >= 0; j--) {
+        d[j] = n % hint.radix;
+        n /= hint.radix;
+    }
+    int plen = (int)strlen(prefix);
+    for (int q = 0; q < len; q++) {
+        char p[MAX_LABEL + 1];
+        memcpy(p, code, plen + q);
+        int prev = plen + q > 0 ? hint_digit(p[plen + q - 1]) : -1;
+        for (int e = d[q] + 1; e < hint.radix; e++) {
+            p[plen + q] = hint.chars[hint.next[prev + 1][e]];
+            p[plen + q + 1] = '\0';
+            label_free(freed, p);
+        }
+    }
+}
+
+/* how likely a target of this role is to be the one wanted */
+static double role_weight(int role) {
+    switch (role) {
+    case ATSPI_ROLE_PUSH_BUTTON:
+    case ATSPI_ROLE_LINK:          return 1.0;
+    case ATSPI_ROLE_ENTRY:         return 0.9;
+    case ATSPI_ROLE_TOGGLE_BUTTON:
+    case ATSPI_ROLE_CHECK_BOX:
+    case ATSPI_ROLE_RADIO_BUTTON:
+    case ATSPI_ROLE_PAGE_TAB:
+    case ATSPI_ROLE_MENU_ITEM:     return 0.8;
+    case ATSPI_ROLE_COMBO_BOX:     return 0.7;
+    case ATSPI_ROLE_TEXT:
+    case ATSPI_ROLE_SPIN_BUTTON:
+    case ATSPI_ROLE_ICON:          return 0.5;
+    case ATSPI_ROLE_SLIDER:
+    case ATSPI_ROLE_LIST_ITEM:
+    case ATSPI_ROLE_TREE_ITEM:     return 0.4;
+    case ATSPI_ROLE_TABLE_CELL:    return 0.3;
+    case ATSPI_ROLE_TOOL_BAR:
+    case ATSPI_ROLE_DOCUMENT_WEB:  return 0.2;
+    default:                       return 0.5;
+    }
+}
+
+/* targets in the focused window count double, each remembered click
+ * adds the base weight again (decaying over history_half_life), and
+ * weight falls off with distance from the pointer (cx < 0: pointer
+ * unknown) */
+#define FOCUS_BOOST   2.0
+#define NEAR_PX       400.0
+
+static double target_weight(const Target *t, gboolean focused, int cx, int cy) {
+    double w = role_weight(t->role);
+    w *= 1.0 + history_weight(t->hkey);
+    if (focused) w *= FOCUS_BOOST;
+    if (cx >= 0) {
+        double d = hypot(t->cx - cx, t->cy - cy);
+        w *= 0.5 + 1.0 / (1.0 + d / NEAR_PX);
+    }
+    return w;
+}
+
+static int weight_cmp(const void *a, const void *b, void *data) {
+    const double *w = data;
+    double wa = w[*(const int *)a], wb = w[*(const int *)b];
+    return wa < wb ? -1 : wa > wb ? 1 : *(const int *)a - *(const int *)b;
+}
+
+/* k-ary huffman code over the weights, below prefix: heavy targets end
+ * up near the root and get short labels, and no label is a prefix of
+ * another, so a hint fires as soon as its label is complete. the tree
+ * is built with the two-queue method (sorted leaves, then merged nodes,
+ * which come out in weight order by construction), padded with
+ * zero-weight leaves so every merge takes exactly radix nodes; their
+ * codes go back into freed. keys are handed out top-down once the tree
+ * is built, so each child knows the key typed before it. returns FALSE
+ * if some label would be longer than MAX_LABEL. */
+static gboolean labels_huffman(char **out, const double *weight, int n,
+                               const char *prefix, GArray *freed)
+{
+    const int k = hint.radix;
+    int plen = (int)strlen(prefix);
+    /* a lone target still needs a key of its own */
+    int pad = n == 1 ? k - 1 : (k - 1 - (n - 1) % (k - 1)) % (k - 1);
+    int nleaves = n + pad;
+    int total = nleaves + (nleaves - 1) / (k - 1);
+
+    double *w = g_new(double, total);
+    int *parent = g_new(int, total);
+    int *digit = g_new(int, total);
+    int *kid = g_new(int, (total - nleaves) * k);  /* ascending weight */
+    int *leaf = g_new(int, nleaves);  /* node -> input index, -1 = padding */
+
+    /* leaves in ascending weight; padding (weight 0) first */
+    double wmax = 0;
+    for (int i = 0; i < n; i++) wmax = MAX(wmax, weight[i]);
+    double *wf = g_new(double, MAX(n, 1));
+    /* floor tiny weights so the tree can't get absurdly deep */
+    for (int i = 0; i < n; i++) wf[i] = MAX(weight[i], wmax * 1e-4 + 1e-12);
+    int *ord = g_new(int, MAX(n, 1));
+    for (int i = 0; i < n; i++) ord[i] = i;
+    g_qsort_with_data(ord, n, sizeof(int), weight_cmp, wf);
+    for (int j = 0; j < pad; j++) { w[j] = 0; leaf[j] = -1; }
+    for (int j = 0; j < n; j++) { w[pad + j] = wf[ord[j]]; leaf[pad + j] = ord[j]; }
+
+    int q1 = 0, q2 = nleaves, next = nleaves;
+    while (next < total) {
+        double sum = 0;
+        for (int j = 0; j < k; j++) {
+            int pick;
+            if (q1 < nleaves && (q2 >= next || w[q1] <= w[q2])) pick = q1++;
+            else pick = q2++;
+            parent[pick] = next;
+            kid[(next - nleaves) * k + j] = pick;
+            sum += w[pick];
+        }
+        w[next++] = sum;
+    }
+    parent[total - 1] = -1;
+
+    /* parents sit above their children, so walking down from the root
+     * gives each node its key before its children need it. the heaviest
+     * child gets the preferred key after its parent's. */
+    digit[total - 1] = plen ? hint_digit(prefix[plen - 1]) : -1;
+    for (int m = total - 1; m >= nleaves; m--) {
+        const guint8 *pref = hint.next[digit[m] + 1];
+        for (int j = 0; j < k; j++)
+            digit[kid[(m - nleaves) * k + j]] = pref[k - 1 - j];
+    }
+
+    char (*code)[MAX_LABEL + 1] = g_malloc(nleaves * sizeof(*code));
+    gboolean ok = TRUE;
+    for (int j = 0; j < nleaves && ok; j++) {
+        char buf[64];
+        int len = 0;
+        for (int v = j; parent[v] >= 0 && len < (int)sizeof(buf); v = parent[v])
+            buf[len++] = hint.chars[digit[v]];
+        if (plen + len > MAX_LABEL) { ok = FALSE; break; }
+        memcpy(code[j], prefix, plen);
+        for (int c = 0; c < len; c++) code[j][plen + c] = buf[len - 1 - c];
+        code[j][plen + len] = '\0';
+    }
+    for (int j = 0; j < nleaves && ok; j++) {
+        if (leaf[j] < 0) label_free(freed, code[j]);
+        else memcpy(out[leaf[j]], code[j], MAX_LABEL + 1);
+    }
+
+    g_free(w); g_free(parent); g_free(digit); g_free(kid); g_free(leaf);
+    g_free(wf); g_free(ord); g_free(code);
+    return ok;
+}
+
+/* n fixed-length codes below prefix, in order; the rest goes to freed */
+static void labels_fixed_in(const char *prefix, char **out, int n, GArray *freed) {
+    int len = 1;
+    for (long p = hint.radix; p < n; p *= hint.radix) len++;
+    for (int i = 0; i < n; i++) label_for(prefix, i, len, out[i]);
+    label_free_rest(freed, prefix, n, len);
+}
+
+static int slot_len_cmp(const void *a, const void *b, void *data) {
+    const LabelSlot *s = data;
+    int la = (int)strlen(s[*(const int *)a].p), lb = (int)strlen(s[*(const int *)b].p);
+    return la != lb ? la - lb : *(const int *)a - *(const int *)b;
+}
+
+/* weighted: the heaviest targets go to the shortest free prefixes. each
+ * prefix takes targets, heaviest first, up to its share of the weight
+ * (by how much of the code space it holds), and codes them with huffman
+ * below itself. a fresh space is a single huffman tree over everything. */
+static void labels_weighted(const GArray *space, char **out, const double *w, int n,
+                            GArray *freed)
+{
+    const LabelSlot *slot = (const LabelSlot *)(const void *)space->data;
+    int ns = space->len;
+    int *so = g_new(int, MAX(ns, 1));
+    for (int j = 0; j < ns; j++) so[j] = j;
+    g_qsort_with_data(so, ns, sizeof(int), slot_len_cmp, (gpointer)slot);
+
+    /* heaviest first */
+    int *ord = g_new(int, MAX(n, 1));
+    for (int i = 0; i < n; i++) ord[i] = i;
+    g_qsort_with_data(ord, n, sizeof(int), weight_cmp, (gpointer)w);
+    for (int i = 0; i < n / 2; i++) {
+        int x = ord[i]; ord[i] = ord[n - 1 - i]; ord[n - 1 - i] = x;
+    }
+
+    double wsum = 0, kraft = 0;
+    for (int i = 0; i < n; i++) wsum += w[i];
+    for (int j = 0; j < ns; j++) kraft += pow(hint.radix, -(double)strlen(slot[j].p));
+
+    char **o = g_new(char *, MAX(n, 1));
+    double *ow = g_new(double, MAX(n, 1));
+    int pos = 0;
+    for (int jj = 0; jj < ns; jj++) {
+        const char *prefix = slot[so[jj]].p;
+        int d = (int)strlen(prefix);
+        double share = pow(hint.radix, -(double)d);
+        if (pos >= n) { label_free(freed, prefix); continue; }
+
+        long cap = slot_capacity(d);
+        double quota = kraft > 0 ? wsum * share / kraft : wsum;
+        double got = 0;
+        int cnt = 0;
+        while (pos + cnt < n && cnt < cap &&
+               (cnt == 0 || jj == ns - 1 || got + w[ord[pos + cnt]] <= quota)) {
+            o[cnt] = out[ord[pos + cnt]];
+            ow[cnt] = w[ord[pos + cnt]];
+            got += ow[cnt++];
+        }
+        wsum -= got;
+        kraft -= share;
+        pos += cnt;
+
+        if (cnt == 1 && d > 0) memcpy(o[0], prefix, MAX_LABEL + 1);
+        else if (!labels_huffman(o, ow, cnt, prefix, freed))
+            labels_fixed_in(prefix, o, cnt, freed);
+    }
+    g_free(so); g_free(ord); g_free(o); g_free(ow);
+}
+
+/* fixed length: the shortest length the free space has room for n
+ * labels of, handed out in order */
+static void labels_fixed(const GArray *space, char **out, int n, GArray *freed) {
+    const LabelSlot *slot = (const LabelSlot *)(const void *)space->data;
+    int ns = space->len;
+    int len = 1;
+    for (; len < MAX_LABEL; len++) {
+        long room = 0;
+        for (int j = 0; j < ns && room < n; j++) {
+            int d = (int)strlen(slot[j].p);
+            if (d <= len) room += slot_capacity(d) / slot_capacity(len);
+        }
+        if (room >= n) break;
+    }
+
+    int pos = 0;
+    for (int j = 0; j < ns; j++) {
+        const char *prefix = slot[j].p;
+        int d = (int)strlen(prefix);
+        if (d > len || pos >= n) { label_free(freed, prefix); continue; }
+        int cnt = (int)MIN(slot_capacity(d) / slot_capacity(len), (long)(n - pos));
+        if (d == len) memcpy(out[pos], prefix, MAX_LABEL + 1);
+        else {
+            for (int i = 0; i < cnt; i++) label_for(prefix, i, len - d, out[pos + i]);
+            label_free_rest(freed, prefix, cnt, len - d);
+        }
+        pos += cnt;
+    }
+}
+
+/* label the n targets tg from the free code space, and leave in space
+ * what's still free. with weights (and labels=weighted) label lengths
+ * follow the weights, otherwise they all get the same length and go out
+ * in order. spare more labels of weight spare_w are set aside as if for
+ * targets still to come, so those find room near the top of the code
+ * space rather than below everything already given out. returns how
+ * many targets are left without a label. */
+static int labels_add(GArray *space, Target **tg, const double *w, int n,
+                      int spare, double spare_w)
+{
+    if (n <= 0) return 0;
+    gboolean weighted = w && cfg.labels == LABELS_WEIGHTED;
+    /* spares only get what the targets leave */
+    long room = 0;
+    for (guint j = 0; j < space->len; j++)
+        room += slot_capacity((int)strlen(g_array_index(space, LabelSlot, j).p));
+    int m = n + (int)CLAMP(room - n, 0, MAX(spare, 0));
+    char *rest = g_malloc0((gsize)(m - n) * (MAX_LABEL + 1) + 1);
+    char **out = g_new(char *, m);
+    double *wt = g_new(double, m);
+    for (int i = 0; i < n; i++) {
+        out[i] = tg[i]->label;
+        out[i][0] = '\0';
+        wt[i] = weighted ? w[i] : 1.0;
+    }
+    for (int i = n; i < m; i++) {
+        out[i] = rest + (i - n) * (MAX_LABEL + 1);
+        wt[i] = weighted ? spare_w : 1.0;
+    }
+
+    GArray *freed = g_array_new(FALSE, FALSE, sizeof(LabelSlot));
+    if (weighted) labels_weighted(space, out, wt, m, freed);
+    else labels_fixed(space, out, m, freed);
+    for (int i = n; i < m; i++)
+        if (out[i][0]) label_free(freed, out[i]);
+    g_array_set_size(space, 0);
+    g_array_append_vals(space, freed->data, freed->len);
+    g_array_free(freed, TRUE);
+
+    int missing = 0;
+    for (int i = 0; i < n; i++)
+        if (!out[i][0]) missing++;
+    g_free(rest);
+    g_free(out);
+    g_free(wt);
+    return missing;
+}
+
+/* how many labels to keep free for apps still out: about as many per
+ * app as the ndone batches so far brought in (have targets) */
+static int labels_spare(int have, int ndone, int more) {
+    return (int)MIN((long)have / MAX(ndone, 1) * more, slot_capacity(0) / 2);
+}
+
+static void labels_warn_missing(int missing) {
+    fprintf(stderr, "[wlim] out of labels: %d targets left without a hint "
+            "(hint_chars has %d keys, labels are up to %d long)\n",
+            missing, hint.radix, MAX_LABEL);
+}
+
+/* average keystrokes per click if targets get picked in proportion to
+ * their weight */
+static double labels_expected(char **labels, const double *w, int n) {
+    double sum = 0, keys = 0;
+    for (int i = 0; i < n; i++) {
+        sum += w[i];
+        keys += w[i] * strlen(labels[i]);
+    }
+    return sum > 0 ? keys / sum : 0;
+}
+
+/* label the targets ids[0..n) of t afresh, from the whole code space */
+static void assign_labels(Target *t, const int *ids, const double *w, int n) {
+    if (n <= 0) return;
+    Target **tg = g_new(Target *, n);
+    for (int i = 0; i < n; i++) tg[i] = &t[ids[i]];
+    GArray *space = g_array_new(FALSE, FALSE, sizeof(LabelSlot));
+    label_space_reset(space);
+    int missing = labels_add(space, tg, w, n, 0, 0);
+    g_array_free(space, TRUE);
+    if (missing > 0) labels_warn_missing(missing);
+
+    if (w && n > hint.radix) {
+        char **out = g_new(char *, n);
+        for (int i = 0; i < n; i++) out[i] = tg[i]->label;
+        fprintf(stderr, "[wlim] %d labels, expected keystrokes %.2f (fixed length: %d)\n",
+                n, labels_expected(out, w, n), label_len(n));
+        g_free(out);
+    }
+    g_free(tg);
+}
+
+/* label t the way a collection does: the focused window (the first
+ * nfocus) on its own, then the rest as BENCH_APPS apps arriving one by
+ * one, each only getting what the labels already shown left free */
+#define BENCH_APPS 4
+static void label_bench_incremental(Target *t, const double *w, int n, int nfocus) {
+    GArray *space = g_array_new(FALSE, FALSE, sizeof(LabelSlot));
+    label_space_reset(space);
+    Target **tg = g_new(Target *, MAX(n, 1));
+    for (int i = 0; i < n; i++) tg[i] = &t[i];
+    int per = (n - nfocus + BENCH_APPS - 1) / BENCH_APPS;
+    for (int b = 0, at = 0; b <= BENCH_APPS && at < n; b++) {
+        int cnt = b == 0 ? nfocus : MIN(per, n - at);
+        double sum = 0;
+        for (int i = at; i < at + cnt; i++) sum += w[i];
+        labels_add(space, tg + at, w + at, cnt, labels_spare(at + cnt, b + 1, BENCH_APPS - b),
+                   cnt > 0 ? sum / cnt / (b == 0 ? FOCUS_BOOST : 1.0) : 0);
+        at += cnt;
+    }
+    g_free(tg);
+    g_array_free(space, TRUE);
+}
+
+/* wlim --label-bench: expected keystrokes per click, weighted vs fixed
+ * length labels, over synthetic screens of n targets with a typical
+ * mix of roles, a focused window and the pointer in the middle. the
+ * "arriving" columns label the same screen the way a collection does,
+ * as the focused window and then a few apps come in, where labels
+ * already on screen can't change */
+static int label_bench(void) {
+    static const AtspiRole mix[] = {
+        ATSPI_ROLE_PUSH_BUTTON, ATSPI_ROLE_PUSH_BUTTON, ATSPI_ROLE_LINK,
+        ATSPI_ROLE_LINK, ATSPI_ROLE_LINK, ATSPI_ROLE_ENTRY,
+        ATSPI_ROLE_MENU_ITEM, ATSPI_ROLE_PAGE_TAB, ATSPI_ROLE_CHECK_BOX,
+        ATSPI_ROLE_LIST_ITEM, ATSPI_ROLE_LIST_ITEM, ATSPI_ROLE_TABLE_CELL,
+        ATSPI_ROLE_TABLE_CELL, ATSPI_ROLE_TREE_ITEM, ATSPI_ROLE_TEXT,
+    };
+    static const int sizes[] = { 20, 50, 100, 300, 1000, 3000, 10000, 50000 };
+    guint32 seed = 12345;
+    #define BENCH_RAND() (seed = seed * 1103515245u + 12345u, (seed >> 8) & 0xffff)
+
+    hint_init(NULL);
+    printf("hint_chars %s\n", hint.chars);
+    printf("%36s %17s\n", "", "---- arriving ---");
+    printf("%8s %8s %8s %8s %8s %8s\n", "targets", "fixed", "weighted", "saved",
+           "fixed", "weighted");
+    for (size_t si = 0; si < G_N_ELEMENTS(sizes); si++) {
+        int n = sizes[si];
+        Target *t = g_new0(Target, n);
+        int *ids = g_new(int, n);
+        double *w = g_new(double, n);
+        char **lab = g_new(char *, n);
+        for (int i = 0; i < n; i++) {
+            t[i].cx = BENCH_RAND() % 2560;
+            t[i].cy = BENCH_RAND() % 1440;
+            t[i].role = mix[BENCH_RAND() % G_N_ELEMENTS(mix)];
+            ids[i] = i;
+            lab[i] = t[i].label;
+            w[i] = target_weight(&t[i], i < n / 4, 1280, 720);
+        }
+        assign_labels(t, ids, w, n);
+        double weighted = labels_expected(lab, w, n);
+        double fixed = label_len(n);
+        label_bench_incremental(t, w, n, n / 4);
+        double inc_weighted = labels_expected(lab, w, n);
+        int mode = cfg.labels;
+        cfg.labels = LABELS_FIXED;
+        label_bench_incremental(t, w, n, n / 4);
+        double inc_fixed = labels_expected(lab, w, n);
+        cfg.labels = mode;
+        printf("%8d %8.2f %8.2f %7.1f%% %8.2f %8.2f\n", n, fixed, weighted,
+               100.0 * (fixed - weighted) / fixed, inc_fixed, inc_weighted);
+        g_free(t); g_free(ids); g_free(w); g_free(lab);
+    }
+    #undef BENCH_RAND
+    return 0;
+}
+
+/* label all of st's targets by target_weight() */
+static void generate_labels(Target *t, int n, int nfocus, int cx, int cy) {
+    int *ids = g_new(int, MAX(n, 1));
+    double *w = g_new(double, MAX(n, 1));
+    for (int i = 0; i < n; i++) {
+        ids[i] = i;
+        w[i] = target_weight(&t[i], i < nfocus, cx, cy);
+    }
+    assign_labels(t, ids, w, n);
+    g_free(ids);
+    g_free(w);
+}
+
+/* ------------------------------------------------------------------ */
+/*  at-spi tree walk                                                   */
+/* ------------------------------------------------------------------ */
+
+typedef struct WinCache WinCache;
+
+/* output of one walk. nodes/wc are only set when walking for the cache */
+typedef struct {
+    TargetStore      *out;
+    GPtrArray        *nodes;  /* source node of each target */
+    WinCache         *wc;     /* record every visited node into this cache */
+    AtspiRect         clip;   /* subtrees wholly outside this are skipped */
+    gboolean          clipped;
+    gint64            deadline;   /* bounded walks give up at this time... */
+    int               cancel_fd;  /* ...or once anything arrives on this (0 = none) */
+    gboolean          stopped;
+} Walk;
+
+/* lists and tables with at least this many rows are entered at the
+ * first row in view instead of at the top */
+#define ROWS_SEEK_MIN 32
+
+static void cache_note_node(WinCache *wc, AtspiAccessible *node,
+                            AtspiAccessible *parent);
+static void cache_note_role(AtspiAccessible *node, AtspiRole role);
+
+/* what walking cost: api calls that may have to ask the app, nodes
+ * looked at and offscreen subtrees skipped. api_calls counts libatspi
+ * calls and our own d-bus calls alike, so it's an upper bound on round
+ * trips: libatspi answers some (role, children, names it was told
+ * about) from its cache without asking anyone. walk_tally keeps running totals for this
+ * process; a WalkStat brackets one window or app with walk_stat_start()
+ * and walk_stat_stop(). */
+typedef struct {
+    gint64 us;
+    guint  api_calls;
+    guint  visited;
+    guint  culled;
+} WalkStat;
+
+static WalkStat walk_tally;
+
+static void walk_stat_start(WalkStat *ws) {
+    *ws = walk_tally;
+    ws->us = g_get_monotonic_time();
+}
+
+static void walk_stat_stop(WalkStat *ws) {
+    ws->us = g_get_monotonic_time() - ws->us;
+    ws->api_calls = walk_tally.api_calls - ws->api_calls;
+    ws->visited = walk_tally.visited - ws->visited;
+    ws->culled = walk_tally.culled - ws->culled;
+}
+
+/* one app's walk has to be done by walk_deadline (0 = no limit), so an
+ * app that answers slowly, or only after each call times out, is given
+ * up on instead of holding everything up */
+static gint64 walk_deadline;
+
+static void items_drop(void);
+
+static void walk_budget_start(void) {
+    items_drop();
+    walk_deadline = cfg.app_budget > 0
+        ? g_get_monotonic_time() + (gint64)cfg.app_budget * 1000 : 0;
+}
+
+static gboolean walk_over_budget(void) {
+    return walk_deadline && g_get_monotonic_time() > walk_deadline;
+}
+
+/* libatspi waits 15 s for an app that has only just started; nothing
+ * one app says is worth more than its whole budget */
+static void a11y_connect(void) {
+    atspi_init();
+    if (cfg.call_timeout > 0)
+        atspi_set_timeout(cfg.call_timeout, MAX(cfg.call_timeout, cfg.app_budget));
+}
+
+/* add a target for node at ext unless it sits on top of the previous
+ * ones. name is asked for only if it isn't known yet. */
+static void walk_add(Walk *wk, AtspiAccessible *node, AtspiRole role,
+                     const AtspiRect *ext, const char *name)
+{
+    if (ext->width <= 0 || ext->height <= 0 ||
+        ts_overlaps(wk->out, ext->x, ext->y, ext->width, ext->height))
+        return;
+
+    Target *t = ts_push(wk->out);
+    t->x = ext->x; t->y = ext->y;
+    t->w = ext->width; t->h = ext->height;
+    t->role = (guint8)role;
+    if (name) {
+        t->name = arena_intern(&wk->out->names, name);
+    } else {
+        walk_tally.api_calls++;
+        gchar *nm = atspi_accessible_get_name(node, NULL);
+        t->name = arena_intern(&wk->out->names, nm);
+        g_free(nm);
+    }
+    if (wk->nodes) g_ptr_array_add(wk->nodes, node);
+}
+
+/* extents of node in screen coords, FALSE if it has none */
+static gboolean node_rect(AtspiAccessible *node, AtspiRect *out) {
+    AtspiComponent *comp = atspi_accessible_get_component_iface(node);
+    if (!comp) return FALSE;
+    GError *err = NULL;
+    walk_tally.api_calls++;
+    AtspiRect *ext = atspi_component_get_extents(comp, ATSPI_COORD_TYPE_SCREEN, &err);
+    g_object_unref(comp);
+    gboolean ok = ext && !err;
+    if (ok) *out = *ext;
+    g_free(ext);
+    if (err) g_error_free(err);
+    return ok;
+}
+
+/* can r be culled by? empty rects and ones pinned at (0,0), which is
+ * what apps with broken coords (GTK4) report, say nothing about where
+ * the element really is */
+static gboolean rect_usable(const AtspiRect *r) {
+    return r->width > 0 && r->height > 0 && (r->x != 0 || r->y != 0);
+}
+
+static gboolean rect_meets(const AtspiRect *a, const AtspiRect *b) {
+    return a->x < b->x + b->width && b->x < a->x + a->width &&
+           a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+static AtspiRect rect_clip(const AtspiRect *a, const AtspiRect *b) {
+    AtspiRect r;
+    r.x = MAX(a->x, b->x);
+    r.y = MAX(a->y, b->y);
+    r.width = MAX(0, MIN(a->x + a->width, b->x + b->width) - r.x);
+    r.height = MAX(0, MIN(a->y + a->height, b->y + b->height) - r.y);
+    return r;
+}
+
+/* start culling against win's extents. on wayland an app doesn't know
+ * where its window is, so the frame may report a screen position while
+ * the contents are window-relative (or the other way round, see
+ * correct_window); the viewport covers both readings. */
+static void walk_viewport(Walk *wk, AtspiAccessible *win) {
+    AtspiRect r;
+    wk->clipped = node_rect(win, &r) && r.width > 0 && r.height > 0;
+    if (!wk->clipped) return;
+    wk->clip.x = MIN(r.x, 0);
+    wk->clip.y = MIN(r.y, 0);
+    wk->clip.width = MAX(r.x, 0) + r.width - wk->clip.x;
+    wk->clip.height = MAX(r.y, 0) + r.height - wk->clip.y;
+}
+
+/* containers whose children are laid out top to bottom in child order */
+static gboolean role_has_rows(AtspiRole role) {
+    return role == ATSPI_ROLE_LIST || role == ATSPI_ROLE_LIST_BOX ||
+           role == ATSPI_ROLE_TABLE || role == ATSPI_ROLE_TREE_TABLE ||
+           role == ATSPI_ROLE_TREE;
+}
+
+/* extents of child i of node, for the binary search */
+static gboolean child_rect(AtspiAccessible *node, int i, AtspiRect *out) {
+    walk_tally.api_calls++;
+    AtspiAccessible *ch = atspi_accessible_get_child_at_index(node, i, NULL);
+    if (!ch) return FALSE;
+    gboolean ok = node_rect(ch, out) && rect_usable(out);
+    g_object_unref(ch);
+    return ok;
+}
+
+/* first of the nc rows of node that doesn't end above the viewport, by
+ * binary search over row extents. 0 (start at the top) if some row
+ * can't say where it is. */
+static int walk_seek_rows(Walk *wk, AtspiAccessible *node, int nc) {
+    int lo = 0, hi = nc;
+    while (lo < hi) {
+        int m = lo + (hi - lo) / 2;
+        AtspiRect r;
+        if (!child_rect(node, m, &r)) return 0;
+        if (r.y + r.height <= wk->clip.y) lo = m + 1;
+        else hi = m;
+    }
+    return lo;
+}
+
+static void walk(Walk *wk, AtspiAccessible *node, AtspiAccessible *parent,
+                 int depth, const AtspiRect *known);
+
+static void walk_child(Walk *wk, AtspiAccessible *node, int i, int depth) {
+    walk_tally.api_calls++;
+    AtspiAccessible *ch = atspi_accessible_get_child_at_index(node, i, NULL);
+    if (ch) { walk(wk, ch, node, depth + 1, NULL); g_object_unref(ch); }
+}
+
+/* the recursive and items walks can stop halfway; the collection walker
+ * is one big request */
+static gboolean walk_stop(Walk *wk) {
+    if (!wk->deadline || wk->stopped) return wk->stopped;
+    struct pollfd p = { .fd = wk->cancel_fd, .events = POLLIN };
+    if (g_get_monotonic_time() > wk->deadline ||
+        (wk->cancel_fd > 0 && poll(&p, 1, 0) > 0))
+        wk->stopped = TRUE;
+    return wk->stopped;
+}
+
+/* timeout in ms for one d-bus call of ours: call_timeout, but no
+ * later than the walk's deadline (-1 = gio's default) */
+static int walk_call_timeout(const Walk *wk) {
+    int ms = cfg.call_timeout > 0 ? cfg.call_timeout : -1;
+    if (wk->deadline) {
+        gint64 left = (wk->deadline - g_get_monotonic_time()) / 1000;
+        ms = (int)CLAMP(left, 1, ms > 0 ? ms : G_MAXINT);
+    }
+    return ms;
+}
+
+/* known: node's extents if the caller already has them, else NULL */
+static void walk(Walk *wk, AtspiAccessible *node, AtspiAccessible *parent,
+                 int depth, const AtspiRect *known)
+{
+    if (!node || depth > 30 || walk_stop(wk)) return;
+    if (wk->wc) cache_note_node(wk->wc, node, parent);
+    walk_tally.visited++;
+
+    GError *err = NULL;
+    walk_tally.api_calls++;
+    AtspiRole role = atspi_accessible_get_role(node, &err);
+    if (err) {
+        g_error_free(err);
+        role = ATSPI_ROLE_INVALID;
+    } else if (depth > 0) {
+        walk_tally.api_calls++;
+        AtspiStateSet *ss = atspi_accessible_get_state_set(node);
+        if (ss) {
+            gboolean ok = atspi_state_set_contains(ss, ATSPI_STATE_VISIBLE)
+                       && atspi_state_set_contains(ss, ATSPI_STATE_SHOWING);
+            g_object_unref(ss);
+            if (!ok) return;
+        }
+    }
+    if (wk->wc) cache_note_role(node, role);
+
+    walk_tally.api_calls++;
+    int nc = atspi_accessible_get_child_count(node, NULL);
+    gboolean clickable = (int)role < 256 && clickable_lut[(int)role];
+
+    /* targets need their extents anyway; containers are asked too, so a
+     * subtree scrolled out of view is skipped without descending */
+    AtspiRect ext;
+    gboolean have_ext = known != NULL;
+    if (known) ext = *known;
+    else have_ext = (clickable || (nc > 0 && depth > 0 && wk->clipped)) &&
+                    node_rect(node, &ext);
+    if (have_ext && wk->clipped && rect_usable(&ext) && !rect_meets(&ext, &wk->clip)) {
+        walk_tally.culled++;
+        return;
+    }
+    if (clickable && have_ext) walk_add(wk, node, role, &ext, NULL);
+    if (nc <= 0) return;
+
+    /* scroll panes clip their contents */
+    AtspiRect outer = wk->clip;
+    gboolean outer_clipped = wk->clipped;
+    if (wk->clipped && have_ext && rect_usable(&ext) &&
+        (role == ATSPI_ROLE_SCROLL_PANE || role == ATSPI_ROLE_VIEWPORT))
+        wk->clip = rect_clip(&wk->clip, &ext);
+
+    if (wk->clipped && nc >= ROWS_SEEK_MIN && role_has_rows(role)) {
+        /* long list or table: start at the first row in view (plus the
+         * first row, which may be a header) and stop below the view */
+        int from = walk_seek_rows(wk, node, nc);
+        if (from > 0) {
+            walk_child(wk, node, 0, depth);
+            walk_tally.culled += from - 1;
+        }
+        for (int i = from; i < nc && !wk->stopped; i++) {
+            walk_tally.api_calls++;
+            AtspiAccessible *ch = atspi_accessible_get_child_at_index(node, i, NULL);
+            if (!ch) continue;
+            AtspiRect r;
+            gboolean have = node_rect(ch, &r);
+            if (have && rect_usable(&r) && r.y >= wk->clip.y + wk->clip.height) {
+                g_object_unref(ch);
+                walk_tally.culled += nc - i;
+                break;
+            }
+            walk(wk, ch, node, depth + 1, have ? &r : NULL);
+            g_object_unref(ch);
+        }
+    } else {
+        for (int i = 0; i < nc && !wk->stopped; i++) walk_child(wk, node, i, depth);
+    }
+
+    wk->clip = outer;
+    wk->clipped = outer_clipped;
+}
+
+/* match rule equivalent to clickable_lut + VISIBLE|SHOWING, built once */
+static AtspiMatchRule *clickable_rule(void) {
+    static AtspiMatchRule *rule;
+    if (rule) return rule;
+
+    AtspiStateSet *ss = atspi_state_set_new(NULL);
+    atspi_state_set_add(ss, ATSPI_STATE_VISIBLE);
+    atspi_state_set_add(ss, ATSPI_STATE_SHOWING);
+
+    GArray *roles = g_array_new(FALSE, FALSE, sizeof(AtspiRole));
+    for (int r = 0; r < 256; r++) {
+        AtspiRole role = (AtspiRole)r;
+        if (clickable_lut[r]) g_array_append_val(roles, role);
+    }
+
+    rule = atspi_match_rule_new(ss, ATSPI_Collection_MATCH_ALL,
+                                NULL, ATSPI_Collection_MATCH_ALL,
+                                roles, ATSPI_Collection_MATCH_ANY,
+                                NULL, ATSPI_Collection_MATCH_ALL,
+                                FALSE);
+    g_object_unref(ss);
+    g_array_free(roles, TRUE);
+    return rule;
+}
+
+/* fetch every clickable, showing node of a window with one GetMatches
+ * call instead of recursing node by node. returns FALSE if the app has
+ * no collection interface (or the call fails) so the caller can fall
+ * back to walk(). */
+static gboolean walk_collection(Walk *wk, AtspiAccessible *win) {
+    AtspiCollection *coll = atspi_accessible_get_collection_iface(win);
+    if (!coll) return FALSE;
+
+    GError *err = NULL;
+    walk_tally.api_calls++;
+    GArray *matches = atspi_collection_get_matches(coll, clickable_rule(),
+                          ATSPI_Collection_SORT_ORDER_CANONICAL, 0, TRUE, &err);
+    g_object_unref(coll);
+    if (err || !matches) {
+        fprintf(stderr, "[wlim] GetMatches failed: %s\n", err ? err->message : "?");
+        if (err) g_error_free(err);
+        if (matches) g_array_free(matches, TRUE);
+        return FALSE;
+    }
+
+    if (wk->wc) cache_note_node(wk->wc, win, NULL);
+
+    walk_tally.visited += matches->len;
+    for (guint i = 0; i < matches->len; i++) {
+        AtspiAccessible *node = g_array_index(matches, AtspiAccessible *, i);
+        /* role and states already matched — only geometry and name left.
+         * extents on a node without Component just fails, which is
+         * cheaper than asking for its interfaces first. */
+        walk_tally.api_calls++;
+        AtspiRect *ext = atspi_component_get_extents(ATSPI_COMPONENT(node),
+                             ATSPI_COORD_TYPE_SCREEN, &err);
+        if (ext && !err && wk->clipped && rect_usable(ext) && !rect_meets(ext, &wk->clip)) {
+            walk_tally.culled++;
+        } else if (ext && !err) {
+            if (wk->wc) cache_note_node(wk->wc, node, win);
+            /* role usually comes from libatspi's cache, not the app */
+            walk_add(wk, node, atspi_accessible_get_role(node, NULL), ext, NULL);
+        }
+        if (ext) g_free(ext);
+        if (err) { g_error_free(err); err = NULL; }
+        g_object_unref(node);
+    }
+    g_array_free(matches, TRUE);
+    return TRUE;
+}
+
+/* our own connection to the accessibility bus, for the calls libatspi
+ * has no api for. per process, so every walk worker opens its own. */
+static GDBusConnection *a11y_bus(void) {
+    static GDBusConnection *bus;
+    static gboolean tried;
+    if (bus || tried) return bus;
+    tried = TRUE;
+
+    GError *err = NULL;
+    gchar *addr = g_strdup(getenv("AT_SPI_BUS_ADDRESS"));
+    if (!addr) {
+        GDBusConnection *session = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, &err);
+        GVariant *r = session ? g_dbus_connection_call_sync(session, "org.a11y.Bus",
+                          "/org/a11y/bus", "org.a11y.Bus", "GetAddress", NULL,
+                          G_VARIANT_TYPE("(s)"), G_DBUS_CALL_FLAGS_NONE, -1, NULL, &err)
+                      : NULL;
+        if (r) {
+            g_variant_get(r, "(s)", &addr);
+            g_variant_unref(r);
+        }
+        if (session) g_object_unref(session);
+    }
+    if (addr)
+        bus = g_dbus_connection_new_for_address_sync(addr,
+                  G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                  G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                  NULL, NULL, err ? NULL : &err);
+    if (!bus)
+        fprintf(stderr, "[wlim] no accessibility bus: %s\n", err ? err->message : "?");
+    g_clear_error(&err);
+    g_free(addr);
+    return bus;
+}
+
+/* one clickable node of a GetItems reply, waiting for its extents */
+typedef struct {
+    const char *path;
+    const char *name;
+    AtspiRole   role;
+    AtspiRect   ext;
+    gboolean    ok;
+    int        *pending;
+} ItemCall;
+
+#define EXTENTS_INFLIGHT 64
+
+static void on_item_extents(GObject *src, GAsyncResult *res, gpointer data) {
+    ItemCall *c = data;
+    GVariant *v = g_dbus_connection_call_finish(G_DBUS_CONNECTION(src), res, NULL);
+    if (v) {
+        g_variant_get(v, "((iiii))", &c->ext.x, &c->ext.y, &c->ext.width, &c->ext.height);
+        c->ok = TRUE;
+        g_variant_unref(v);
+    }
+    (*c->pending)--;
+}
+
+static gboolean item_has_state(GVariant *states, int st) {
+    gsize n;
+    const guint32 *w = g_variant_get_fixed_array(states, &n, sizeof(guint32));
+    return (gsize)(st / 32) < n && (w[st / 32] >> (st % 32)) & 1;
+}
+
+static gboolean item_has_component(GVariant *ifaces) {
+    gsize n;
+    const gchar **v = g_variant_get_strv(ifaces, &n);
+    gboolean has = FALSE;
+    for (gsize i = 0; i < n && !has; i++)
+        has = strcmp(v[i], "org.a11y.atspi.Component") == 0;
+    g_free(v);
+    return has;
+}
+
+/* an app's GetItems reply, kept for the rest of that app's walk so all
+ * its windows are picked out of one tree */
+typedef struct {
+    int          app;       /* index of the app on the desktop, -1 = none */
+    char        *bus;       /* the app's name on the a11y bus */
+    char        *root;      /* and the path of its application object */
+    GVariant    *reply, *items;
+    int          n;
+    GVariant   **item;
+    const char **path;
+    int         *parent;    /* index of each item's parent, -1 = not in the tree */
+    GHashTable  *by_path;   /* path -> index + 1 */
+    int          f_ifaces, f_name, f_role, f_states;
+    gboolean     indexed;   /* items carry their index in parent (2.46+) */
+} ItemsTree;
+
+static ItemsTree items_tree = { .app = -1 };
+
+static void items_drop(void) {
+    ItemsTree *t = &items_tree;
+    for (int i = 0; i < t->n; i++) g_variant_unref(t->item[i]);
+    g_free(t->item);
+    g_free(t->path);
+    g_free(t->parent);
+    if (t->by_path) g_hash_table_destroy(t->by_path);
+    if (t->items) g_variant_unref(t->items);
+    if (t->reply) g_variant_unref(t->reply);
+    g_free(t->bus);
+    g_free(t->root);
+    memset(t, 0, sizeof(*t));
+    t->app = -1;
+}
+
+/* the registry's list of apps, asked for once per collection */
+static GVariant *items_apps;
+
+static void items_apps_drop(void) {
+    if (items_apps) g_variant_unref(items_apps);
+    items_apps = NULL;
+}
+
+/* bus name and root path of the i-th app on the desktop. libatspi has
+ * no api for them, but the registry lists the apps in the same order. */
+static gboolean items_app_address(Walk *wk, GDBusConnection *bus, int i,
+                                  char **name, char **path)
+{
+    if (!items_apps) {
+        walk_tally.api_calls++;
+        GVariant *r = g_dbus_connection_call_sync(bus, "org.a11y.atspi.Registry",
+                          "/org/a11y/atspi/accessible/root", "org.a11y.atspi.Accessible",
+                          "GetChildren", NULL, G_VARIANT_TYPE("(a(so))"),
+                          G_DBUS_CALL_FLAGS_NONE, walk_call_timeout(wk), NULL, NULL);
+        if (!r) return FALSE;
+        items_apps = g_variant_get_child_value(r, 0);
+        g_variant_unref(r);
+    }
+    gboolean ok = i >= 0 && (gsize)i < g_variant_n_children(items_apps);
+    if (ok) g_variant_get_child(items_apps, i, "(so)", name, path);
+    return ok;
+}
+
+/* the GetItems tree of win's app, fetched the first time one of its
+ * windows asks. NULL if the app has no cache interface. */
+static ItemsTree *items_fetch(Walk *wk, GDBusConnection *bus, AtspiAccessible *win) {
+    walk_tally.api_calls++;
+    AtspiAccessible *app = atspi_accessible_get_application(win, NULL);
+    if (app) walk_tally.api_calls++;
+    int ai = app ? atspi_accessible_get_index_in_parent(app, NULL) : -1;
+    if (app) g_object_unref(app);
+    if (ai < 0) return NULL;
+    ItemsTree *t = &items_tree;
+    if (t->app == ai) return t->reply ? t : NULL;
+
+    /* a failed fetch isn't tried again for the app's other windows */
+    items_drop();
+    t->app = ai;
+    if (walk_stop(wk) || !items_app_address(wk, bus, ai, &t->bus, &t->root)) return NULL;
+
+    GError *err = NULL;
+    walk_tally.api_calls++;
+    GVariant *reply = g_dbus_connection_call_sync(bus, t->bus,
+                          "/org/a11y/atspi/cache", "org.a11y.atspi.Cache", "GetItems",
+                          NULL, NULL, G_DBUS_CALL_FLAGS_NONE, walk_call_timeout(wk),
+                          NULL, &err);
+    if (!reply) {
+        fprintf(stderr, "[wlim] GetItems failed: %s\n", err ? err->message : "?");
+        g_clear_error(&err);
+        return NULL;
+    }
+
+    /* at-spi2 2.46 replaced each item's child list with its index and
+     * child count, which moves the fields after it */
+    const char *ty = g_variant_get_type_string(reply);
+    if (strcmp(ty, "(a((so)(so)(so)iiassusau))") == 0) {
+        t->f_ifaces = 5; t->f_name = 6; t->f_role = 7; t->f_states = 9;
+        t->indexed = TRUE;
+    } else if (strcmp(ty, "(a((so)(so)(so)a(so)assusau))") == 0) {
+        t->f_ifaces = 4; t->f_name = 5; t->f_role = 6; t->f_states = 8;
+    } else {
+        fprintf(stderr, "[wlim] GetItems: unknown reply %s\n", ty);
+        g_variant_unref(reply);
+        return NULL;
+    }
+
+    t->reply = reply;
+    t->items = g_variant_get_child_value(reply, 0);
+    int n = t->n = (int)g_variant_n_children(t->items);
+    t->item = g_new(GVariant *, MAX(n, 1));
+    t->path = g_new(const char *, MAX(n, 1));
+    t->parent = g_new(int, MAX(n, 1));
+    t->by_path = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int i = 0; i < n; i++) {
+        t->item[i] = g_variant_get_child_value(t->items, i);
+        const char *bn;
+        g_variant_get_child(t->item[i], 0, "(&s&o)", &bn, &t->path[i]);
+        g_hash_table_insert(t->by_path, (gpointer)t->path[i], GINT_TO_POINTER(i + 1));
+    }
+    for (int i = 0; i < n; i++) {
+        const char *bn, *pp;
+        g_variant_get_child(t->item[i], 2, "(&s&o)", &bn, &pp);
+        t->parent[i] = GPOINTER_TO_INT(g_hash_table_lookup(t->by_path, pp)) - 1;
+    }
+    return t;
+}
+
+/* the item of the app's k-th window, -1 if the tree doesn't have it */
+static int items_window(const ItemsTree *t, int k) {
+    if (k < 0) return -1;
+    if (t->indexed) {
+        for (int i = 0; i < t->n; i++) {
+            const char *bn, *pp;
+            int idx;
+            g_variant_get_child(t->item[i], 2, "(&s&o)", &bn, &pp);
+            g_variant_get_child(t->item[i], 3, "i", &idx);
+            if (idx == k && strcmp(pp, t->root) == 0) return i;
+        }
+        return -1;
+    }
+    int r = GPOINTER_TO_INT(g_hash_table_lookup(t->by_path, t->root)) - 1;
+    if (r < 0) return -1;
+    GVariant *kids = g_variant_get_child_value(t->item[r], 3);
+    int w = -1;
+    if ((gsize)k < g_variant_n_children(kids)) {
+        const char *bn, *kp;
+        g_variant_get_child(kids, k, "(&s&o)", &bn, &kp);
+        w = GPOINTER_TO_INT(g_hash_table_lookup(t->by_path, kp)) - 1;
+    }
+    g_variant_unref(kids);
+    return w;
+}
+
+/* walk a window out of the app's bridge cache: one GetItems call per
+ * app brings role, name, states, interfaces and parent of every node
+ * the bridge knows, the window's showing subtree is picked out of that
+ * locally, and only its clickable nodes are asked for extents. those
+ * calls are pipelined, so a window costs about one round trip, plus one
+ * per app, instead of several calls per node. returns FALSE if the app
+ * has no cache interface or the window isn't in it, so the caller can
+ * fall back. */
+static gboolean walk_items(Walk *wk, AtspiAccessible *win) {
+    GDBusConnection *bus = a11y_bus();
+    ItemsTree *t = bus ? items_fetch(wk, bus, win) : NULL;
+    if (!t) return wk->stopped;
+
+    walk_tally.api_calls++;
+    int root = items_window(t, atspi_accessible_get_index_in_parent(win, NULL));
+    if (root >= 0) {
+        /* the registry's list of apps may have moved since libatspi's */
+        const char *iname;
+        g_variant_get_child(t->item[root], t->f_name, "&s", &iname);
+        walk_tally.api_calls++;
+        gchar *name = atspi_accessible_get_name(win, NULL);
+        if (g_strcmp0(name, iname) != 0) root = -1;
+        g_free(name);
+    }
+    if (root < 0) {
+        fprintf(stderr, "[wlim] GetItems: window not in the app's cache\n");
+        return FALSE;
+    }
+
+    int n = t->n;
+    GVariant **item = t->item;
+    const char **path = t->path;
+    const int *parent = t->parent;
+    int f_ifaces = t->f_ifaces, f_name = t->f_name, f_role = t->f_role, f_states = t->f_states;
+    guint8 *in = g_new0(guint8, MAX(n, 1));  /* 1 = showing under win, 2 = not, 3 = being resolved */
+    int *stack = g_new(int, MAX(n, 1));
+
+    /* a node counts if it and every ancestor up to the window are
+     * visible and showing, same as walk() descending */
+    for (int i = 0; i < n; i++) {
+        int sp = 0, j = i;
+        while (in[j] == 0) {
+            if (j == root) { in[j] = 1; break; }
+            GVariant *states = g_variant_get_child_value(item[j], f_states);
+            gboolean showing = item_has_state(states, ATSPI_STATE_VISIBLE) &&
+                               item_has_state(states, ATSPI_STATE_SHOWING);
+            g_variant_unref(states);
+            if (!showing || parent[j] < 0) { in[j] = 2; break; }
+            in[j] = 3;
+            stack[sp++] = j;
+            j = parent[j];
+        }
+        guint8 v = in[j] == 3 ? 2 : in[j];  /* 3: a parent cycle */
+        while (sp > 0) in[stack[--sp]] = v;
+    }
+
+    ItemCall *calls = g_new0(ItemCall, MAX(n, 1));
+    int ncalls = 0;
+    for (int i = 0; i < n; i++) {
+        if (in[i] != 1 || i == root) continue;
+        walk_tally.visited++;
+        guint32 role;
+        g_variant_get_child(item[i], f_role, "u", &role);
+        if (role >= 256 || !clickable_lut[role]) continue;
+        GVariant *ifaces = g_variant_get_child_value(item[i], f_ifaces);
+        gboolean comp = item_has_component(ifaces);
+        g_variant_unref(ifaces);
+        if (!comp) continue;
+        ItemCall *c = &calls[ncalls++];
+        c->path = path[i];
+        c->role = (AtspiRole)role;
+        g_variant_get_child(item[i], f_name, "&s", &c->name);
+    }
+
+    /* extents for the candidates, a window of calls in flight at once.
+     * replies are dispatched on a private context so nothing else runs
+     * while we wait. past the deadline the rest are called off and the
+     * window keeps what came back. */
+    int pending = 0, sent = 0;
+    GMainContext *ctx = g_main_context_new();
+    GCancellable *cancel = g_cancellable_new();
+    g_main_context_push_thread_default(ctx);
+    while (pending > 0 || (sent < ncalls && !wk->stopped)) {
+        if (walk_stop(wk)) g_cancellable_cancel(cancel);
+        while (sent < ncalls && pending < EXTENTS_INFLIGHT && !wk->stopped) {
+            ItemCall *c = &calls[sent++];
+            c->pending = &pending;
+            pending++;
+            walk_tally.api_calls++;
+            g_dbus_connection_call(bus, t->bus, c->path,
+                                   "org.a11y.atspi.Component", "GetExtents",
+                                   g_variant_new("(u)", (guint32)ATSPI_COORD_TYPE_SCREEN),
+                                   G_VARIANT_TYPE("((iiii))"), G_DBUS_CALL_FLAGS_NONE,
+                                   walk_call_timeout(wk), cancel, on_item_extents, c);
+        }
+        if (pending > 0) g_main_context_iteration(ctx, TRUE);
+    }
+    g_main_context_pop_thread_default(ctx);
+    g_main_context_unref(ctx);
+    g_object_unref(cancel);
+
+    /* targets have no node of their own; the cache treats the window as
+     * flat and re-walks it whole on any change in the app */
+    if (wk->wc) cache_note_node(wk->wc, win, NULL);
+    for (int k = 0; k < ncalls; k++) {
+        ItemCall *c = &calls[k];
+        if (!c->ok) continue;
+        if (wk->clipped && rect_usable(&c->ext) && !rect_meets(&c->ext, &wk->clip)) {
+            walk_tally.culled++;
+            continue;
+        }
+        walk_add(wk, win, c->role, &c->ext, c->name);
+    }
+
+    g_free(calls);
+    g_free(in);
+    g_free(stack);
+    return TRUE;
+}
+
+/* walk one top-level window with the configured engine. returns TRUE if
+ * a flat engine (collection or items) was used, i.e. targets have no
+ * known ancestry. */
+static gboolean walk_window(Walk *wk, AtspiAccessible *win) {
+    WalkStat ws;
+    walk_stat_start(&ws);
+    walk_viewport(wk, win);
+
+    gboolean flat = FALSE;
+    if (cfg.walker == WALKER_COLLECTION) flat = walk_collection(wk, win);
+    else if (cfg.walker == WALKER_ITEMS) flat = walk_items(wk, win);
+    if (!flat && cfg.walker != WALKER_RECURSIVE) {
+        gchar *nm = atspi_accessible_get_name(win, NULL);
+        fprintf(stderr, "[wlim] %s walker unavailable for \"%s\", walking recursively\n",
+                cfg.walker == WALKER_ITEMS ? "items" : "collection", nm ? nm : "?");
+        g_free(nm);
+    }
+    if (!flat) walk(wk, win, NULL, 0, NULL);
+
+    walk_stat_stop(&ws);
+    fprintf(stderr, "[wlim] walked window in %.1f ms: %d targets, %u nodes, %u api calls, "
+            "%u offscreen subtree(s) skipped\n", ws.us / 1000.0, wk->out->n,
+            ws.visited, ws.api_calls, ws.culled);
+    return flat;
+}
+
+/* ------------------------------------------------------------------ */
+/*  target cache — daemon only, kept current by AT-SPI events          */
+/* ------------------------------------------------------------------ */
+
+/* every node a cached walk visits is remembered along with its parent,
+ * so an event on any of them can be mapped back to its window and the
+ * affected subtree re-walked without asking the app where it lives. */
+typedef struct {
+    AtspiAccessible *parent;  /* NULL for the window itself */
+    WinCache        *wc;
+    AtspiRole        role;    /* as walked, ATSPI_ROLE_INVALID if unknown */
+} CacheNode;
+
+struct WinCache {
+    AtspiAccessible  *win;
+    TargetStore       ts;       /* raw, before coordinate correction */
+    GPtrArray        *nodes;    /* source node of each target */
+    GHashTable       *dirty;    /* nodes whose subtree must be re-walked */
+    gboolean          flat;     /* collection walk: only targets are known */
+    int               pid;      /* of the app */
+    gboolean          walked;
+    gint64            walked_us;
+    guint             round;    /* last collection that saw this window */
+};
+
+static GHashTable *cache_nodes;    /* AtspiAccessible* -> CacheNode */
+static GHashTable *win_caches;     /* window AtspiAccessible* -> WinCache */
+static GHashTable *cache_orphans;  /* event sources we never visited */
+static guint       cache_round;
+
+
+static void cache_note_node(WinCache *wc, AtspiAccessible *node,
+                            AtspiAccessible *parent)
+{
+    CacheNode *cn = g_hash_table_lookup(cache_nodes, node);
+    if (!cn) {
+        cn = g_new0(CacheNode, 1);
+        g_hash_table_insert(cache_nodes, g_object_ref(node), cn);
+    }
+    cn->parent = parent;
+    cn->wc = wc;
+    cn->role = ATSPI_ROLE_INVALID;
+}
+
+static void cache_note_role(AtspiAccessible *node, AtspiRole role) {
+    CacheNode *cn = g_hash_table_lookup(cache_nodes, node);
+    if (cn) cn->role = role;
+}
+
+/* scrolling moves a scroll pane's contents without an event for any of
+ * them, and the walk only went into the part that was in view. what an
+ * app does say is that the scroll bar's value or the visible data
+ * changed: re-walk the scroll pane (or viewport) around it. */
+static AtspiAccessible *cache_scroller(AtspiAccessible *node) {
+    AtspiAccessible *first = node;
+    while (node) {
+        CacheNode *cn = g_hash_table_lookup(cache_nodes, node);
+        if (!cn) break;
+        if (cn->role == ATSPI_ROLE_SCROLL_PANE || cn->role == ATSPI_ROLE_VIEWPORT)
+            return node;
+        node = cn->parent;
+    }
+    return first;
+}
+
+/* is node (or one of its known ancestors) in set? no IPC. */
+static gboolean cache_under(AtspiAccessible *node, GHashTable *set) {
+    while (node) {
+        if (g_hash_table_contains(set, node)) return TRUE;
+        CacheNode *cn = g_hash_table_lookup(cache_nodes, node);
+        if (!cn) break;
+        node = cn->parent;
+    }
+    return FALSE;
+}
+
+/* drop remembered nodes of wc, either all or only those under roots */
+static void cache_forget(WinCache *wc, GHashTable *roots) {
+    GPtrArray *gone = g_ptr_array_new();
+    GHashTableIter it;
+    gpointer key, val;
+    g_hash_table_iter_init(&it, cache_nodes);
+    while (g_hash_table_iter_next(&it, &key, &val)) {
+        CacheNode *cn = val;
+        if (cn->wc == wc && (!roots || cache_under(key, roots)))
+            g_ptr_array_add(gone, key);
+    }
+    for (guint i = 0; i < gone->len; i++)
+        g_hash_table_remove(cache_nodes, g_ptr_array_index(gone, i));
+    g_ptr_array_free(gone, TRUE);
+}
+
+static void cache_walk_into(WinCache *wc, AtspiAccessible *node,
+                            AtspiAccessible *parent, int depth)
+{
+    Walk wk = { .out = &wc->ts, .nodes = wc->nodes, .wc = wc, .deadline = walk_deadline };
+    if (node == wc->win) {
+        wc->flat = walk_window(&wk, node);
+    } else {
+        walk_viewport(&wk, wc->win);
+        walk(&wk, node, parent, depth, NULL);
+    }
+}
+
+/* bring a window's targets up to date, re-walking only dirty subtrees */
+static void cache_refresh(WinCache *wc) {
+    gint64 now = g_get_monotonic_time();
+    if (wc->walked && now - wc->walked_us > (gint64)cfg.cache_max_age * G_USEC_PER_SEC)
+        wc->walked = FALSE;
+
+    if (!wc->walked) {
+        g_hash_table_remove_all(wc->dirty);
+        cache_forget(wc, NULL);
+        ts_reset(&wc->ts);
+        g_ptr_array_set_size(wc->nodes, 0);
+        cache_walk_into(wc, wc->win, NULL, 0);
+        wc->walked = !walk_over_budget();  /* cut short: walk it all next time */
+        wc->walked_us = now;
+        return;
+    }
+
+    if (g_hash_table_size(wc->dirty) == 0) return;
+
+    /* take the dirty set before walking — events that arrive while we
+     * talk to the app land in a fresh set for the next trigger */
+    GHashTable *dirty = wc->dirty;
+    wc->dirty = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    /* only re-walk the topmost dirty nodes */
+    GHashTable *roots = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GPtrArray *root_list = g_ptr_array_new();
+    GHashTableIter it;
+    gpointer key, val;
+    g_hash_table_iter_init(&it, dirty);
+    while (g_hash_table_iter_next(&it, &key, &val)) {
+        CacheNode *cn = g_hash_table_lookup(cache_nodes, key);
+        if (!cn || (cn->parent && cache_under(cn->parent, dirty))) continue;
+        g_hash_table_add(roots, key);
+        g_ptr_array_add(root_list, key);
+    }
+
+    /* parent and depth of each root, captured before forgetting them */
+    int nroots = root_list->len;
+    AtspiAccessible **rparent = g_new(AtspiAccessible *, nroots);
+    int *rdepth = g_new(int, nroots);
+    for (int r = 0; r < nroots; r++) {
+        AtspiAccessible *node = g_ptr_array_index(root_list, r);
+        rparent[r] = ((CacheNode *)g_hash_table_lookup(cache_nodes, node))->parent;
+        rdepth[r] = 0;
+        for (AtspiAccessible *a = rparent[r]; a; rdepth[r]++) {
+            CacheNode *cn = g_hash_table_lookup(cache_nodes, a);
+            a = cn ? cn->parent : NULL;
+        }
+        g_object_ref(node);
+        if (rparent[r]) g_object_ref(rparent[r]);
+    }
+
+    int kept = 0;
+    for (int t = 0; t < wc->ts.n; t++) {
+        if (cache_under(g_ptr_array_index(wc->nodes, t), roots)) continue;
+        wc->ts.t[kept] = wc->ts.t[t];
+        g_ptr_array_index(wc->nodes, kept) = g_ptr_array_index(wc->nodes, t);
+        kept++;
+    }
+    wc->ts.n = kept;
+    ts_grid_invalidate(&wc->ts);
+    g_ptr_array_set_size(wc->nodes, kept);
+    cache_forget(wc, roots);
+
+    for (int r = 0; r < nroots; r++) {
+        AtspiAccessible *node = g_ptr_array_index(root_list, r);
+        cache_walk_into(wc, node, rparent[r], rdepth[r]);
+        g_object_unref(node);
+        if (rparent[r]) g_object_unref(rparent[r]);
+    }
+    if (walk_over_budget()) wc->walked = FALSE;
+    fprintf(stderr, "[wlim] cache: re-walked %d subtree(s), %d targets\n",
+            nroots, wc->ts.n);
+
+    g_free(rparent);
+    g_free(rdepth);
+    g_ptr_array_free(root_list, TRUE);
+    g_hash_table_destroy(roots);
+    g_hash_table_destroy(dirty);
+}
+
+static WinCache *cache_window(AtspiAccessible *win) {
+    WinCache *wc = g_hash_table_lookup(win_caches, win);
+    if (!wc) {
+        wc = g_new0(WinCache, 1);
+        wc->win = g_object_ref(win);
+        wc->pid = (int)atspi_accessible_get_process_id(win, NULL);
+        wc->nodes = g_ptr_array_new();
+        wc->dirty = g_hash_table_new(g_direct_hash, g_direct_equal);
+        g_hash_table_insert(win_caches, wc->win, wc);
+    }
+    wc->round = cache_round;
+    return wc;
+}
+
+/* drop windows that weren't seen in the last collection */
+static void cache_sweep(void) {
+    GHashTableIter it;
+    gpointer key, val;
+    GPtrArray *gone = g_ptr_array_new();
+    g_hash_table_iter_init(&it, win_caches);
+    while (g_hash_table_iter_next(&it, &key, &val))
+        if (((WinCache *)val)->round != cache_round)
+            g_ptr_array_add(gone, val);
+
+    for (guint i = 0; i < gone->len; i++) {
+        WinCache *wc = g_ptr_array_index(gone, i);
+        cache_forget(wc, NULL);
+        g_hash_table_remove(win_caches, wc->win);
+        g_hash_table_destroy(wc->dirty);
+        ts_free(&wc->ts);
+        g_ptr_array_free(wc->nodes, TRUE);
+        g_free(wc);
+    }
+    g_ptr_array_free(gone, TRUE);
+}
+
+/* an event on a node we never visited usually belongs to a subtree we
+ * skipped (not showing). if its parent is known, re-walk from there. */
+static void cache_resolve_orphans(void) {
+    GHashTable *orphans = cache_orphans;
+    cache_orphans = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                          g_object_unref, NULL);
+    GHashTableIter it;
+    gpointer key, val;
+    g_hash_table_iter_init(&it, orphans);
+    while (g_hash_table_iter_next(&it, &key, &val)) {
+        AtspiAccessible *parent = atspi_accessible_get_parent(key, NULL);
+        if (!parent) continue;
+        CacheNode *cn = g_hash_table_lookup(cache_nodes, parent);
+        if (cn) g_hash_table_add(cn->wc->dirty, parent);
+        g_object_unref(parent);
+    }
+    g_hash_table_destroy(orphans);
+}
+
+/* a collection-walked window doesn't know its containers, so any
+ * unknown node changing in the same app invalidates the whole window */
+static gboolean cache_mark_flat(AtspiAccessible *src) {
+    gboolean hit = FALSE;
+    int pid = 0;  /* asked for only if there's a flat window */
+    GHashTableIter it;
+    gpointer key, val;
+    g_hash_table_iter_init(&it, win_caches);
+    while (g_hash_table_iter_next(&it, &key, &val)) {
+        WinCache *wc = val;
+        if (!wc->flat) continue;
+        if (!pid) pid = (int)atspi_accessible_get_process_id(src, NULL);
+        if (pid > 0 && wc->pid == pid) {
+            g_hash_table_add(wc->dirty, wc->win);
+            hit = TRUE;
+        }
+    }
+    return hit;
+}
+
+static gboolean is_value_event(const AtspiEvent *ev) {
+    return g_str_has_prefix(ev->type, "object:value-changed") ||
+           g_str_has_prefix(ev->type, "object:property-change:accessible-value");
+}
+
+/* of value changes only a scroll bar's matter; sliders and progress
+ * bars change value all the time */
+static gboolean cache_ignore_event(const AtspiEvent *ev) {
+    if (!is_value_event(ev)) return FALSE;
+    CacheNode *cn = g_hash_table_lookup(cache_nodes, ev->source);
+    AtspiRole role = cn && cn->role != ATSPI_ROLE_INVALID
+                   ? cn->role : atspi_accessible_get_role(ev->source, NULL);
+    return role != ATSPI_ROLE_SCROLL_BAR;
+}
+
+static void on_a11y_event(AtspiEvent *ev, void *data) {
+    if (ev->source && !cache_ignore_event(ev)) {
+        CacheNode *cn = g_hash_table_lookup(cache_nodes, ev->source);
+        if (cn && (is_value_event(ev) ||
+                   g_str_has_prefix(ev->type, "object:visible-data-changed"))) {
+            AtspiAccessible *from = is_value_event(ev) && cn->parent ? cn->parent : ev->source;
+            g_hash_table_add(cn->wc->dirty, cache_scroller(from));
+        } else if (cn)
+            g_hash_table_add(cn->wc->dirty, ev->source);
+        else if (cache_mark_flat(ev->source))
+            ;
+        else if (g_hash_table_size(cache_orphans) < 256 &&
+                 !g_hash_table_contains(cache_orphans, ev->source))
+            g_hash_table_add(cache_orphans, g_object_ref(ev->source));
+    }
+    g_boxed_free(ATSPI_TYPE_EVENT, ev);
+}
+
+static void cache_init(void) {
+    if (cfg.cache_max_age <= 0) return;
+
+    cache_nodes = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                        g_object_unref, g_free);
+    win_caches = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                       g_object_unref, NULL);
+    cache_orphans = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                          g_object_unref, NULL);
+
+    static const char *events[] = {
+        "object:children-changed",
+        "object:state-changed:showing",
+        "object:bounds-changed",
+        "object:visible-data-changed",
+        "object:value-changed",
+        "object:property-change:accessible-value",
+    };
+    AtspiEventListener *l = atspi_event_listener_new(on_a11y_event, NULL, NULL);
+    for (size_t i = 0; i < sizeof(events)/sizeof(events[0]); i++) {
+        GError *err = NULL;
+        if (!atspi_event_listener_register(l, events[i], &err)) {
+            fprintf(stderr, "[wlim] cannot listen for %s: %s\n",
+                    events[i], err ? err->message : "?");
+            if (err) g_error_free(err);
+        }
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  per-app results and the walk pool                                  */
+/* ------------------------------------------------------------------ */
+
+/* how a window's coordinates were fixed up, see correct_window() */
+enum { CORRECT_NONE, CORRECT_OFFSET, CORRECT_GRID };
+
+/* one window's targets, raw until correct_result() fixes them in place */
+typedef struct {
+    char        title[256];
+    TargetStore ts;
+    WalkStat    stat;
+    int         correction;  /* CORRECT_*, once corrected */
+} WinResult;
+
+typedef struct {
+    int        pid;
+    WinResult *wins;
+    int        nwins;
+    gboolean   done;
+    gboolean   slow;   /* went over cfg.app_budget, dropped */
+    gboolean   shown;  /* merged into the overlay */
+} AppResult;
+
+static TargetStore walk_buf;
+
+static void app_result_add(AppResult *r, const char *title,
+                           const TargetStore *src, const WalkStat *ws)
+{
+    r->wins = g_renew(WinResult, r->wins, r->nwins + 1);
+    WinResult *wr = &r->wins[r->nwins++];
+    snprintf(wr->title, sizeof(wr->title), "%s", title ? title : "");
+    wr->stat = *ws;
+    memset(&wr->ts, 0, sizeof(wr->ts));
+    ts_append(&wr->ts, src, 0, src->n);
+}
+
+static void app_result_clear(AppResult *r) {
+    for (int k = 0; k < r->nwins; k++) ts_free(&r->wins[k].ts);
+    g_free(r->wins);
+    r->wins = NULL;
+    r->nwins = 0;
+    r->done = FALSE;
+}
+
+/* walk one window in this process, through the cache if there is one */
+static void walk_app_window(AtspiAccessible *w, AppResult *r) {
+    const TargetStore *src;
+    WalkStat ws;
+    walk_stat_start(&ws);
+    if (win_caches) {
+        WinCache *wc = cache_window(w);
+        cache_refresh(wc);
+        src = &wc->ts;
+    } else {
+        ts_reset(&walk_buf);
+        Walk wk = { .out = &walk_buf, .deadline = walk_deadline };
+        walk_window(&wk, w);
+        src = &walk_buf;
+    }
+    walk_stat_stop(&ws);
+
+    if (src->n > 0) {
+        gchar *title = atspi_accessible_get_name(w, NULL);
+        app_result_add(r, title, src, &ws);
+        g_free(title);
+    }
+}
+
+/* walk every window of one app in this process, except window `skip` */
+static void walk_app(AtspiAccessible *app, AppResult *r, int skip) {
+    walk_budget_start();
+    int nwins = atspi_accessible_get_child_count(app, NULL);
+    for (int k = 0; k < nwins && !walk_over_budget(); k++) {
+        if (k == skip) continue;
+        AtspiAccessible *w = atspi_accessible_get_child_at_index(app, k, NULL);
+        if (!w) continue;
+        walk_app_window(w, r);
+        g_object_unref(w);
+    }
+    if (walk_over_budget()) {
+        app_result_clear(r);
+        r->slow = TRUE;
+    } else {
+        r->done = TRUE;
+    }
+    walk_deadline = 0;
+}
+
+/* index of the app's window hyprland calls title: prefer a title match,
+ * else whichever window says it's active. -1 if neither. */
+static int focus_window(AtspiAccessible *app, const char *title) {
+    int found = -1;
+    int nwins = atspi_accessible_get_child_count(app, NULL);
+    for (int k = 0; k < nwins; k++) {
+        AtspiAccessible *w = atspi_accessible_get_child_at_index(app, k, NULL);
+        if (!w) continue;
+        gchar *name = atspi_accessible_get_name(w, NULL);
+        gboolean hit = name && titles_match(name, title);
+        g_free(name);
+        if (!hit && found < 0) {
+            AtspiStateSet *ss = atspi_accessible_get_state_set(w);
+            if (ss && atspi_state_set_contains(ss, ATSPI_STATE_ACTIVE))
+                found = k;
+            if (ss) g_object_unref(ss);
+        }
+        g_object_unref(w);
+        if (hit) return k;
+    }
+    return found;
+}
+
+/* libatspi is not thread safe (one shared connection, re-entrant main
+ * loop inside every call), so the pool is made of forked processes,
+ * each with its own AT-SPI connection. they're started before the
+ * parent touches AT-SPI or GTK and walk whole apps on request. */
+#define MAX_WORKERS 16
+
+typedef struct { int app_index; int pid; int skip; guint gen; } PoolJob;
+/* n<0: end of app, see POOL_*. followed by n Targets and names_len arena bytes */
+typedef struct { int n; guint32 names_len; char title[256]; WalkStat stat; } PoolWin;
+
+#define POOL_END    -1
+#define POOL_FAILED -2
+#define POOL_SLOW   -3  /* over cfg.app_budget */
+
+static struct {
+    int   fd;
+    int   job;    /* app index being walked, -1 when idle */
+    guint gen;    /* collection the job belongs to */
+    pid_t pid;
+} pool[MAX_WORKERS];
+static int pool_n;
+
+static int read_full(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n; len -= n;
+    }
+    return 0;
+}
+
+static int write_full(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n; len -= n;
+    }
+    return 0;
+}
+
+/* apps can come and go between the parent's listing and ours */
+static AtspiAccessible *pool_find_app(AtspiAccessible *desktop, int idx, int pid) {
+    AtspiAccessible *app = atspi_accessible_get_child_at_index(desktop, idx, NULL);
+    if (app && (int)atspi_accessible_get_process_id(app, NULL) == pid) return app;
+    if (app) g_object_unref(app);
+
+    int napps = atspi_accessible_get_child_count(desktop, NULL);
+    for (int i = 0; i < napps; i++) {
+        app = atspi_accessible_get_child_at_index(desktop, i, NULL);
+        if (app && (int)atspi_accessible_get_process_id(app, NULL) == pid) return app;
+        if (app) g_object_unref(app);
+    }
+    return NULL;
+}
+
+/* send walk_buf as window w's targets */
+static int pool_write_win(int fd, AtspiAccessible *w, const WalkStat *ws) {
+    gchar *title = atspi_accessible_get_name(w, NULL);
+    PoolWin hdr = { .n = walk_buf.n, .names_len = walk_buf.names.len, .stat = *ws };
+    snprintf(hdr.title, sizeof(hdr.title), "%s", title ? title : "");
+    g_free(title);
+    /* name offsets stay valid against the copied arena */
+    if (write_full(fd, &hdr, sizeof(hdr)) < 0 ||
+        write_full(fd, walk_buf.t, walk_buf.n * sizeof(Target)) < 0 ||
+        write_full(fd, walk_buf.names.buf, walk_buf.names.len) < 0)
+        return -1;
+    return 0;
+}
+
+static void pool_worker(int fd) {
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    init_clickable_lut();
+    a11y_connect();
+
+    PoolJob job;
+    guint gen = 0;
+    while (read_full(fd, &job, sizeof(job)) == 0) {
+        if (job.gen != gen) items_apps_drop();  /* a new collection */
+        gen = job.gen;
+        AtspiAccessible *desktop = atspi_get_desktop(0);
+        AtspiAccessible *app = pool_find_app(desktop, job.app_index, job.pid);
+        PoolWin hdr = { .n = POOL_FAILED };
+
+        if (app) {
+            walk_budget_start();
+            int nwins = atspi_accessible_get_child_count(app, NULL);
+            for (int k = 0; k < nwins && !walk_over_budget(); k++) {
+                if (k == job.skip) continue;
+                AtspiAccessible *w = atspi_accessible_get_child_at_index(app, k, NULL);
+                if (!w) continue;
+                ts_reset(&walk_buf);
+                Walk wk = { .out = &walk_buf, .deadline = walk_deadline };
+                WalkStat ws;
+                walk_stat_start(&ws);
+                walk_window(&wk, w);
+                walk_stat_stop(&ws);
+                if (walk_buf.n > 0 && pool_write_win(fd, w, &ws) < 0) _exit(1);
+                g_object_unref(w);
+            }
+            g_object_unref(app);
+            hdr.n = walk_over_budget() ? POOL_SLOW : POOL_END;
+            walk_deadline = 0;
+        }
+        g_object_unref(desktop);
+        if (write_full(fd, &hdr, sizeof(hdr)) < 0) break;
+    }
+    _exit(0);
+}
+
+static void pool_start(int n) {
+    if (n > MAX_WORKERS) n = MAX_WORKERS;
+    for (int i = 0; i < n; i++) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) break;
+        pid_t pid = fork();
+        if (pid < 0) { close(sv[0]); close(sv[1]); break; }
+        if (pid == 0) {
+            for (int j = 0; j < pool_n; j++) close(pool[j].fd);
+            close(sv[0]);
+            pool_worker(sv[1]);
+        }
+        close(sv[1]);
+        pool[pool_n].fd = sv[0];
+        pool[pool_n].job = -1;
+        pool[pool_n].pid = pid;
+        pool_n++;
+    }
+}
+
+static gboolean pool_send(int w, int app_index, int pid, int skip, guint gen) {
+    PoolJob job = { .app_index = app_index, .pid = pid, .skip = skip, .gen = gen };
+    if (write_full(pool[w].fd, &job, sizeof(job)) < 0) return FALSE;
+    pool[w].job = app_index;
+    return TRUE;
+}
+
+static int pool_find(int fd) {
+    for (int w = 0; w < pool_n; w++)
+        if (pool[w].fd == fd) return w;
+    return -1;
+}
+
+static void pool_kill(int w) {
+    close(pool[w].fd);
+    kill(pool[w].pid, SIGTERM);
+    waitpid(pool[w].pid, NULL, 0);
+    pool[w] = pool[--pool_n];
+}
+
+/* one message off a worker's socket: a window's targets go into in */
+static gboolean pool_read(int fd, PoolWin *hdr, TargetStore *in) {
+    gboolean ok = read_full(fd, hdr, sizeof(*hdr)) == 0 &&
+                  hdr->n != 0 && hdr->n >= POOL_SLOW;
+    if (ok && hdr->n > 0) {
+        in->t = g_new(Target, hdr->n);
+        in->n = in->cap = hdr->n;
+        in->names.buf = g_malloc(hdr->names_len + 1);
+        in->names.len = in->names.cap = hdr->names_len;
+        ok = read_full(fd, in->t, hdr->n * sizeof(Target)) == 0 &&
+             read_full(fd, in->names.buf, hdr->names_len) == 0;
+        in->names.buf[hdr->names_len] = '\0';
+        hdr->title[sizeof(hdr->title) - 1] = '\0';
+    }
+    return ok;
+}
+
+/* read one message from worker w into r. returns 0 if more windows are
+ * coming, 1 when the job is finished (r->done says whether it worked)
+ * and -1 if the worker died — it is removed from the pool then. */
+static int pool_recv(int w, AppResult *r) {
+    PoolWin hdr;
+    TargetStore in = {0};
+    if (!pool_read(pool[w].fd, &hdr, &in)) {
+        fprintf(stderr, "[wlim] walk worker died (pid %d)\n", (int)pool[w].pid);
+        ts_free(&in);
+        app_result_clear(r);
+        pool_kill(w);
+        return -1;
+    }
+
+    if (hdr.n > 0) {
+        app_result_add(r, hdr.title, &in, &hdr.stat);
+        ts_free(&in);
+        return 0;
+    }
+
+    if (hdr.n == POOL_END) r->done = TRUE;
+    else app_result_clear(r);
+    r->slow = hdr.n == POOL_SLOW;
+    pool[w].job = -1;
+    return 1;
+}
+
+/* ------------------------------------------------------------------ */
+/*  coordinate correction and collection                               */
+/* ------------------------------------------------------------------ */
+
+/* fix up the n targets of one window using its hyprland geometry.
+ * for windows with broken coords (GTK4), fall back to a grid; drops
+ * the window (*n = 0) if there's no geometry to grid over. */
+static int correct_window(Target *tg, int *n, const HyprClients *clients,
+                          int pid, const char *title)
+{
+    int count = *n;
+
+    /* look up this window's actual geometry from hyprctl */
+    int wx = 0, wy = 0, ww = 0, wh = 0;
+    const HyprClient *hc = hypr_client_by_pid(clients, pid);
+    if (!hc) hc = hypr_client_by_title(clients, title);
+    gboolean found = hc != NULL;
+    if (hc) {
+        wx = hc->x; wy = hc->y;
+        ww = hc->w; wh = hc->h;
+    }
+
+    fprintf(stderr, "[wlim] window \"%s\": %d targets, geom found=%d at=(%d,%d) size=(%d,%d) pid_atspi=%d\n",
+            title[0] ? title : "?", count, found, wx, wy, ww, wh, pid);
+
+    /* check if this window's coords are usable */
+    int zeros = 0;
+    for (int t = 0; t < count; t++)
+        if (tg[t].x == 0 && tg[t].y == 0) zeros++;
+
+    if ((double)zeros / count >= 0.8) {
+        /* broken coords (GTK4) — distribute in a grid */
+        if (found && ww > 0 && wh > 0) {
+            int m = 30;
+            int gx = wx + m, gy = wy + m;
+            int gw = ww - m*2, gh = wh - m*2;
+            int cols = (int)ceil(sqrt((double)count));
+            int rows = (int)ceil((double)count / cols);
+            double cw = (double)gw / (cols ? cols : 1);
+            double ch = (double)gh / (rows ? rows : 1);
+            for (int t = 0; t < count; t++) {
+                int px = (int)(gx + (t % cols) * cw + cw / 2);
+                int py = (int)(gy + (t / cols) * ch + ch / 2);
+                tg[t].lx = px;
+                tg[t].ly = py;
+                tg[t].cx = px;
+                tg[t].cy = py;
+            }
+        } else {
+            *n = 0;
+        }
+        return CORRECT_GRID;
+    }
+
+    /* coords are present — check if they're window-relative.
+     * on wayland, some apps (chromium) report AT-SPI coords
+     * relative to the window instead of the screen. detect
+     * this by checking if all coords fall within [0, ww) x
+     * [0, wh) rather than [wx, wx+ww) x [wy, wy+wh). */
+    int off_x = 0, off_y = 0;
+    if (found && ww > 0 && wh > 0 && (wx > 0 || wy > 0)) {
+        int window_rel = 0;
+        for (int t = 0; t < count; t++) {
+            if (tg[t].x >= 0 && tg[t].x < ww &&
+                tg[t].y >= 0 && tg[t].y < wh)
+                window_rel++;
+        }
+        /* if most coords fit inside [0,ww)x[0,wh) but the
+         * window isn't at (0,0), they're window-relative */
+        fprintf(stderr, "[wlim]   window_rel=%d/%d (%.0f%%)\n",
+                window_rel, count, 100.0 * window_rel / count);
+        if ((double)window_rel / count >= 0.8) {
+            off_x = wx;
+            off_y = wy;
+            fprintf(stderr, "[wlim]   applying offset (%d,%d)\n", off_x, off_y);
+        }
+    }
+
+    for (int t = 0; t < count; t++) {
+        tg[t].cx = tg[t].x + off_x + tg[t].w / 2;
+        tg[t].cy = tg[t].y + off_y + tg[t].h / 2;
+        tg[t].lx = tg[t].x + off_x + 16;
+        tg[t].ly = tg[t].y + off_y + 8;
+    }
+    return off_x || off_y ? CORRECT_OFFSET : CORRECT_NONE;
+}
+
+static void correct_result(AppResult *r, const HyprClients *clients) {
+    for (int k = 0; k < r->nwins; k++) {
+        r->wins[k].correction = correct_window(r->wins[k].ts.t, &r->wins[k].ts.n,
+                                               clients, r->pid, r->wins[k].title);
+        const HyprClient *hc = hypr_client_by_pid(clients, r->pid);
+        if (!hc) hc = hypr_client_by_title(clients, r->wins[k].title);
+        history_stamp(&r->wins[k].ts, hc ? hc->cls : "");
+    }
+}
+
+/* note what walking one app cost, once its result is in */
+static void stats_app(const AppResult *r) {
+    if (!stats.on) return;
+    GString *o = stats.apps;
+    if (o->len) g_string_append_c(o, ',');
+    g_string_append_printf(o, "{\"pid\":%d,\"done_us\":%lld,\"over_budget\":%s,\"windows\":[",
+                           r->pid, (long long)(g_get_monotonic_time() - stats.start_us),
+                           r->slow ? "true" : "false");
+    for (int k = 0; k < r->nwins; k++) {
+        const WinResult *wr = &r->wins[k];
+        g_string_append(o, k ? ",{\"title\":" : "{\"title\":");
+        json_str(o, wr->title);
+        g_string_append_printf(o, ",\"walk_us\":%lld,\"api_calls\":%u,\"visited\":%u,"
+                               "\"culled\":%u,\"targets\":%d}",
+                               (long long)wr->stat.us, wr->stat.api_calls, wr->stat.visited,
+                               wr->stat.culled, wr->ts.n);
+        stats.walk_us += wr->stat.us;
+        stats.walk_api_calls += wr->stat.api_calls;
+        stats.walk_visited += wr->stat.visited;
+        stats.walk_culled += wr->stat.culled;
+    }
+    g_string_append(o, "]}");
+}
+
+/* print this run's line, once. times are integer µs, so the output
+ * doesn't depend on the locale gtk sets up. */
+static void stats_emit(void) {
+    if (!stats.on || stats.emitted) return;
+    stats.emitted = TRUE;
+
+    static const char *const walkers[] = { "recursive", "collection", "items" };
+    GString *o = g_string_new(NULL);
+    g_string_append_printf(o, "{\"mode\":\"%s\",\"walker\":\"%s\",\"targets\":%d,\"phases_us\":{",
+                           stats.daemon ? "daemon" : "oneshot", walkers[cfg.walker], stats.targets);
+    gboolean first = TRUE;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        if (!stats.at[i]) continue;
+        g_string_append_printf(o, "%s\"%s\":%lld", first ? "" : ",",
+                               phase_names[i], (long long)stats.at[i]);
+        first = FALSE;
+    }
+    g_string_append_printf(o,
+        "},\"hypr\":{\"calls\":%u,\"us\":%lld},\"labels_us\":%lld,\"render_us\":%lld,"
+        "\"keys\":{\"count\":%u,\"us\":%lld},\"click_us\":%lld,"
+        "\"walk\":{\"us\":%lld,\"api_calls\":%u,\"visited\":%u,\"culled\":%u},",
+        stats.hypr_calls, (long long)stats.hypr_us,
+        (long long)stats.labels_us, (long long)stats.render_us,
+        stats.keys, (long long)stats.keys_us, (long long)stats.click_us,
+        (long long)stats.walk_us, stats.walk_api_calls, stats.walk_visited, stats.walk_culled);
+    if (stats.prewalk_on)
+        g_string_append_printf(o, "\"prewalk\":{\"ready\":%s,\"hits\":%u,\"triggers\":%u},",
+                               stats.prewalk_ready ? "true" : "false",
+                               stats.prewalk_hits, stats.prewalk_triggers);
+    g_string_append_printf(o, "\"apps\":[%s]}", stats.apps ? stats.apps->str : "");
+    printf("%s\n", o->str);
+    fflush(stdout);
+    g_string_free(o, TRUE);
+}
+
+/* append an app's (already corrected) windows to ts */
+static void merge_result(TargetStore *ts, const AppResult *r) {
+    for (int k = 0; k < r->nwins; k++)
+        ts_append(ts, &r->wins[k].ts, 0, r->wins[k].ts.n);
+}
+
+/* ------------------------------------------------------------------ */
+/*  window snapshots — the last walk, shown while walking again        */
+/* ------------------------------------------------------------------ */
+
+/* every walked window's corrected targets are written to
+ * $XDG_CACHE_HOME/wlim/snapshots/<address>-<title hash>. on a trigger,
+ * if the focused window has a recent snapshot and hyprland reports the
+ * same geometry, its hints go up straight away and the real walk only
+ * starts once they're painted. fresh targets that were shown from the
+ * snapshot (same role, name and click point) get their label back, so
+ * the hints don't shuffle under the user's fingers. */
+#define SNAPSHOT_MAGIC "wlimsnp1"
+
+typedef struct {
+    char    magic[8];
+    guint32 target_size;   /* sizeof(Target), in case the layout changes */
+    gint32  x, y, w, h;    /* window geometry when saved */
+    gint32  n;             /* targets that follow */
+    guint32 names_len;     /* then the names they point into */
+} SnapHeader;
+
+static gboolean snapshot_dir(char *buf, size_t sz) {
+    if (cfg.snapshot_max_age <= 0) return FALSE;
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    if (xdg && xdg[0])
+        snprintf(buf, sz, "%s/wlim/snapshots", xdg);
+    else if (home)
+        snprintf(buf, sz, "%s/.cache/wlim/snapshots", home);
+    else
+        return FALSE;
+    return TRUE;
+}
+
+static gboolean snapshot_path(const HyprClient *hc, char *buf, size_t sz) {
+    char dir[512];
+    if (!hc || !hc->address[0] || !snapshot_dir(dir, sizeof(dir))) return FALSE;
+    snprintf(buf, sz, "%s/%s-%08x", dir, hc->address, g_str_hash(hc->title));
+    return TRUE;
+}
+
+/* the client an AT-SPI window belongs to. by_pid alone would give every
+ * window of a multi-window app the first one's address. */
+static const HyprClient *snapshot_client(const HyprClients *hc, int pid,
+                                         const char *title)
+{
+    const HyprClient *only = NULL;
+    int n = 0;
+    for (int i = 0; i < hc->n; i++) {
+        if (hc->c[i].pid != pid) continue;
+        if (titles_match(hc->c[i].title, title)) return &hc->c[i];
+        only = &hc->c[i];
+        n++;
+    }
+    return n == 1 ? only : NULL;
+}
+
+/* drop snapshots too old to ever be shown, at most once an hour */
+static void snapshot_prune(const char *dir) {
+    static gint64 last;
+    gint64 now = g_get_monotonic_time();
+    if (last && now - last < (gint64)3600 * G_USEC_PER_SEC) return;
+    last = now;
+
+    GDir *d = g_dir_open(dir, 0, NULL);
+    if (!d) return;
+    const char *name;
+    time_t cutoff = time(NULL) - cfg.snapshot_max_age;
+    while ((name = g_dir_read_name(d))) {
+        char path[800];
+        struct stat sb;
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        if (stat(path, &sb) == 0 && sb.st_mtime < cutoff) unlink(path);
+    }
+    g_dir_close(d);
+}
+
+static void snapshot_save_window(const WinResult *wr, const HyprClient *hc) {
+    char dir[512], path[600], tmp[620];
+    if (wr->ts.n == 0 || !snapshot_path(hc, path, sizeof(path))) return;
+    snapshot_dir(dir, sizeof(dir));
+    g_mkdir_with_parents(dir, 0700);
+    snapshot_prune(dir);
+
+    SnapHeader h = {
+        .target_size = sizeof(Target),
+        .x = hc->x, .y = hc->y, .w = hc->w, .h = hc->h,
+        .n = wr->ts.n, .names_len = wr->ts.names.len,
+    };
+    memcpy(h.magic, SNAPSHOT_MAGIC, 8);
+
+    /* write and rename, so a concurrent trigger never reads half a file */
+    snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return;
+    gboolean ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+                  fwrite(wr->ts.t, sizeof(Target), wr->ts.n, f) == (size_t)wr->ts.n &&
+                  fwrite(wr->ts.names.buf, 1, wr->ts.names.len, f) == wr->ts.names.len;
+    if (fclose(f) != 0) ok = FALSE;
+    if (!ok || rename(tmp, path) < 0) unlink(tmp);
+}
+
+/* snapshot an app's windows, once corrected */
+static void snapshot_save(const AppResult *r) {
+    if (cfg.snapshot_max_age <= 0) return;
+    const HyprClients *clients = hypr_clients();
+    for (int k = 0; k < r->nwins; k++) {
+        const HyprClient *hc = snapshot_client(clients, r->pid, r->wins[k].title);
+        if (hc) snapshot_save_window(&r->wins[k], hc);
+    }
+}
+
+/* the window's last targets, if they're recent and it hasn't moved or
+ * been resized since */
+static gboolean snapshot_load(const HyprClient *hc, TargetStore *ts) {
+    char path[600];
+    struct stat sb;
+    if (!snapshot_path(hc, path, sizeof(path)) || stat(path, &sb) < 0 ||
+        time(NULL) - sb.st_mtime > cfg.snapshot_max_age)
+        return FALSE;
+
+    gchar *data;
+    gsize len;
+    if (!g_file_get_contents(path, &data, &len, NULL)) return FALSE;
+    const SnapHeader *h = (const SnapHeader *)data;
+    gboolean ok = len >= sizeof(*h) && memcmp(h->magic, SNAPSHOT_MAGIC, 8) == 0 &&
+                  h->target_size == sizeof(Target) && h->n > 0 && h->names_len > 0 &&
+                  len == sizeof(*h) + (gsize)h->n * sizeof(Target) + h->names_len &&
+                  h->x == hc->x && h->y == hc->y && h->w == hc->w && h->h == hc->h;
+    if (ok) {
+        const Target *t = (const Target *)(data + sizeof(*h));
+        const char *names = (const char *)(t + h->n);
+        ok = names[h->names_len - 1] == '\0';
+        ts_reset(ts);
+        for (int i = 0; ok && i < h->n; i++) {
+            if (t[i].name >= h->names_len) continue;
+            Target *d = ts_push(ts);
+            *d = t[i];
+            d->label[0] = '\0';
+            d->name = arena_intern(&ts->names, names + t[i].name);
+        }
+        ok = ok && ts->n > 0;
+    }
+    g_free(data);
+    return ok;
+}
+
+static char *pin_key(const TargetStore *ts, int i) {
+    const Target *t = &ts->t[i];
+    return g_strdup_printf("%d,%d,%d,%s", t->role, t->cx, t->cy, ts_name(ts, i));
+}
+
+/* remember the labels just shown from a snapshot */
+static void labels_pin_save(State *st) {
+    if (st->pins) g_hash_table_destroy(st->pins);
+    st->pins = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    for (int i = 0; i < st->ts.n; i++)
+        if (st->ts.t[i].label[0])
+            g_hash_table_replace(st->pins, pin_key(&st->ts, i), g_strdup(st->ts.t[i].label));
+}
+
+/* give target i of ts the label it was shown with from the snapshot,
+ * if it was. each label goes back once: the snapshot's labels left the
+ * code space when they were shown, so they can't clash with any other. */
+static gboolean labels_pin(State *st, TargetStore *ts, int i) {
+    if (!st->pins) return FALSE;
+    char *key = pin_key(ts, i);
+    const char *want = g_hash_table_lookup(st->pins, key);
+    if (want) {
+        snprintf(ts->t[i].label, sizeof(ts->t[i].label), "%s", want);
+        g_hash_table_remove(st->pins, key);
+    }
+    g_free(key);
+    return want != NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/*  pre-walk — the daemon walks a window as soon as it gets focus      */
+/* ------------------------------------------------------------------ */
+
+/* on activewindow events the daemon has a helper process walk the newly
+ * focused window and saves the result as its snapshot, so the next
+ * trigger has targets to show straight away. the helper runs at the
+ * lowest priority, gives up after prewalk_budget ms and drops a walk as
+ * soon as it's sent anything else — another window or a trigger. */
+#define PREWALK_DELAY_MS  150  /* let alt-tab and focus-follows-mouse settle */
+#define PREWALK_GAP_S     5    /* don't walk the same window again sooner */
+
+typedef struct { int pid; char title[256]; } PrewalkJob;  /* pid 0: stop */
+
+static struct {
+    int       fd;           /* -1 when off */
+    pid_t     pid;
+    guint     timer;
+    guint     sent, answered;  /* every job is answered; only the last counts */
+    AppResult res;
+    char      address[32];  /* client being walked, "" when idle */
+    gint64    start_us;
+    char      ready[32];    /* client the last finished pre-walk saved */
+    gint64    ready_us;
+    guint     hits, triggers;
+} prewalk = { .fd = -1 };
+
+static void prewalk_worker(int fd) {
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    setpriority(PRIO_PROCESS, 0, 19);
+    init_clickable_lut();
+    a11y_connect();
+
+    PrewalkJob job;
+    while (read_full(fd, &job, sizeof(job)) == 0) {
+        PoolWin hdr = { .n = POOL_FAILED };
+        if (job.pid <= 0) {
+            if (write_full(fd, &hdr, sizeof(hdr)) < 0) break;
+            continue;
+        }
+        job.title[sizeof(job.title) - 1] = '\0';
+        items_drop();
+        items_apps_drop();
+
+        AtspiAccessible *desktop = atspi_get_desktop(0);
+        AtspiAccessible *app = pool_find_app(desktop, 0, job.pid);
+        int k = app ? focus_window(app, job.title) : -1;
+        AtspiAccessible *w = k >= 0 ? atspi_accessible_get_child_at_index(app, k, NULL) : NULL;
+        if (w) {
+            ts_reset(&walk_buf);
+            Walk wk = {
+                .out = &walk_buf, .cancel_fd = fd,
+                .deadline = g_get_monotonic_time() + (gint64)cfg.prewalk_budget * 1000,
+            };
+            WalkStat ws;
+            walk_stat_start(&ws);
+            walk_window(&wk, w);
+            walk_stat_stop(&ws);
+            if (!wk.stopped) {
+                if (walk_buf.n > 0 && pool_write_win(fd, w, &ws) < 0) _exit(1);
+                hdr.n = POOL_END;
+            }
+            g_object_unref(w);
+        }
+        if (app) g_object_unref(app);
+        g_object_unref(desktop);
+        if (write_full(fd, &hdr, sizeof(hdr)) < 0) break;
+    }
+    _exit(0);
+}
+
+static gboolean on_prewalk(int fd, GIOCondition cond, gpointer data) {
+    (void)cond; (void)data;
+    PoolWin hdr;
+    TargetStore in = {0};
+    if (!pool_read(fd, &hdr, &in)) {
+        fprintf(stderr, "[wlim] prewalk worker died (pid %d)\n", (int)prewalk.pid);
+        ts_free(&in);
+        app_result_clear(&prewalk.res);
+        close(prewalk.fd);
+        kill(prewalk.pid, SIGTERM);
+        waitpid(prewalk.pid, NULL, 0);
+        prewalk.fd = -1;
+        if (prewalk.timer) g_source_remove(prewalk.timer);
+        prewalk.timer = 0;
+        return G_SOURCE_REMOVE;
+    }
+    if (hdr.n > 0) {
+        app_result_add(&prewalk.res, hdr.title, &in, &hdr.stat);
+        ts_free(&in);
+        return G_SOURCE_CONTINUE;
+    }
+
+    /* an answer to a job that's since been replaced is of no use */
+    if (++prewalk.answered == prewalk.sent && prewalk.address[0]) {
+        double ms = (g_get_monotonic_time() - prewalk.start_us) / 1000.0;
+        if (hdr.n == POOL_END && prewalk.res.nwins > 0) {
+            correct_result(&prewalk.res, hypr_clients());
+            snapshot_save(&prewalk.res);
+            snprintf(prewalk.ready, sizeof(prewalk.ready), "%s", prewalk.address);
+            prewalk.ready_us = g_get_monotonic_time();
+            fprintf(stderr, "[wlim] prewalk: %d targets ready in %.1f ms\n",
+                    prewalk.res.nwins ? prewalk.res.wins[0].ts.n : 0, ms);
+        } else if (hdr.n == POOL_FAILED) {
+            fprintf(stderr, "[wlim] prewalk: gave up after %.1f ms\n", ms);
+        }
+        prewalk.address[0] = '\0';
+    }
+    app_result_clear(&prewalk.res);
+    return G_SOURCE_CONTINUE;
+}
+
+static void prewalk_start(void) {
+    if (cfg.prewalk_budget <= 0 || cfg.snapshot_max_age <= 0) return;
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0) return;
+    pid_t pid = fork();
+    if (pid < 0) { close(sv[0]); close(sv[1]); return; }
+    if (pid == 0) {
+        for (int j = 0; j < pool_n; j++) close(pool[j].fd);
+        close(sv[0]);
+        prewalk_worker(sv[1]);
+    }
+    close(sv[1]);
+    prewalk.fd = sv[0];
+    prewalk.pid = pid;
+}
+
+static void prewalk_send(int pid, const char *title) {
+    PrewalkJob job = { .pid = pid };
+    snprintf(job.title, sizeof(job.title), "%s", title);
+    /* a dead worker is noticed by on_prewalk */
+    if (write_full(prewalk.fd, &job, sizeof(job)) == 0) prewalk.sent++;
+    prewalk.res.pid = pid;
+}
+
+static gboolean prewalk_cb(gpointer data) {
+    (void)data;
+    prewalk.timer = 0;
+    const HyprClient *hc = hypr_active();
+    if (!hc || hc->pid <= 0 || !hc->address[0]) return G_SOURCE_REMOVE;
+    if (strcmp(hc->address, prewalk.address) == 0) return G_SOURCE_REMOVE;
+    if (strcmp(hc->address, prewalk.ready) == 0 &&
+        g_get_monotonic_time() - prewalk.ready_us < (gint64)PREWALK_GAP_S * G_USEC_PER_SEC)
+        return G_SOURCE_REMOVE;
+
+    prewalk_send(hc->pid, hc->title);
+    snprintf(prewalk.address, sizeof(prewalk.address), "%s", hc->address);
+    prewalk.start_us = g_get_monotonic_time();
+    return G_SOURCE_REMOVE;
+}
+
+/* focus moved: walk the new window once it's stayed put for a moment */
+static void prewalk_schedule(void) {
+    if (prewalk.fd < 0) return;
+    if (prewalk.timer) g_source_remove(prewalk.timer);
+    prewalk.timer = g_timeout_add_full(G_PRIORITY_LOW, PREWALK_DELAY_MS,
+                                       prewalk_cb, NULL, NULL);
+}
+
+/* a trigger: the app has to answer us now, so drop any pre-walk, and
+ * count whether one left this window's snapshot ready */
+static void prewalk_trigger(const HyprClient *active, gboolean snap) {
+    if (prewalk.fd < 0) return;
+    if (prewalk.timer) g_source_remove(prewalk.timer);
+    prewalk.timer = 0;
+    if (prewalk.address[0]) {
+        prewalk_send(0, "");
+        prewalk.address[0] = '\0';
+    }
+
+    prewalk.triggers++;
+    gboolean hit = snap && active && strcmp(active->address, prewalk.ready) == 0;
+    if (hit) prewalk.hits++;
+    prewalk.ready[0] = '\0';
+    fprintf(stderr, "[wlim] prewalk: snapshot %s, ready for %u of %u triggers\n",
+            hit ? "ready" : "missed", prewalk.hits, prewalk.triggers);
+    stats.prewalk_on = TRUE;
+    stats.prewalk_ready = hit;
+    stats.prewalk_hits = prewalk.hits;
+    stats.prewalk_triggers = prewalk.triggers;
+}
+
+/* ------------------------------------------------------------------ */
+/*  uinput — direct virtual input device                               */
+/* ------------------------------------------------------------------ */
+
+static void emit(int fd, int type, int code, int val) {
+    struct input_event ev = {0};
+    ev.type = type;
+    ev.code = code;
+    ev.value = val;
+    write(fd, &ev, sizeof(ev));
+}
+
+/* the virtual pointer is created once and kept. a fresh device isn't
+ * usable until the compositor has picked it up, which used to cost a
+ * 50ms sleep on every click; now only a click racing a just-created
+ * device waits, for whatever is left of that. */
+#define POINTER_SETTLE_US 50000
+/* and it shouldn't vanish before the compositor has read the last click */
+#define POINTER_DRAIN_US  20000
+
+static struct {
+    int    fd;
+    int    w, h;          /* screen size the abs axes were set up for */
+    gint64 created_us;
+    gint64 clicked_us;
+} pointer = { .fd = -1 };
+
+static void pointer_close(void) {
+    if (pointer.fd < 0) return;
+    gint64 left = pointer.clicked_us + POINTER_DRAIN_US - g_get_monotonic_time();
+    if (pointer.clicked_us && left > 0) usleep(left);
+    ioctl(pointer.fd, UI_DEV_DESTROY);
+    close(pointer.fd);
+    pointer.fd = -1;
+}
+
+/* create the device, or recreate it if the screen size changed */
+static void pointer_open(void) {
+    int sw, sh;
+    hypr_screen_bounds(&sw, &sh);
+    if (pointer.fd >= 0 && pointer.w == sw && pointer.h == sh) return;
+    pointer_close();
+
+    int fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "[wlim] cannot open /dev/uinput: %s\n", strerror(errno));
         return;
     }
 
@@ -633,7 +3849,9 @@ static void do_click(int x, int y, int button) {
     ioctl(fd, UI_SET_EVBIT, EV_SYN);
     ioctl(fd, UI_SET_ABSBIT, ABS_X);
     ioctl(fd, UI_SET_ABSBIT, ABS_Y);
-    ioctl(fd, UI_SET_KEYBIT, button);
+    ioctl(fd, UI_SET_KEYBIT, BTN_LEFT);
+    ioctl(fd, UI_SET_KEYBIT, BTN_RIGHT);
+    ioctl(fd, UI_SET_KEYBIT, BTN_MIDDLE);
 
     /* configure abs axes to match screen pixel dimensions */
     struct uinput_abs_setup abs_x = {0};
@@ -656,10 +3874,29 @@ static void do_click(int x, int y, int button) {
     setup.id.product = 0x5678;
     setup.id.version = 1;
     ioctl(fd, UI_DEV_SETUP, &setup);
-    ioctl(fd, UI_DEV_CREATE);
+    if (ioctl(fd, UI_DEV_CREATE) < 0) {
+        fprintf(stderr, "[wlim] cannot create uinput device: %s\n", strerror(errno));
+        close(fd);
+        return;
+    }
+
+    pointer.fd = fd;
+    pointer.w = sw;
+    pointer.h = sh;
+    pointer.created_us = g_get_monotonic_time();
+}
 
-    /* small delay for compositor to register the new device */
-    usleep(50000);
+static void do_click(int x, int y, int button) {
+    pointer_open();
+    if (pointer.fd < 0) return;
+    int fd = pointer.fd, sw = pointer.w, sh = pointer.h;
+
+    gint64 age = g_get_monotonic_time() - pointer.created_us;
+    if (age < POINTER_SETTLE_US) {
+        fprintf(stderr, "[wlim] pointer device is new, waiting %.1f ms\n",
+                (POINTER_SETTLE_US - age) / 1000.0);
+        usleep(POINTER_SETTLE_US - age);
+    }
 
     /* clamp coordinates */
     if (x < 0) x = 0;
@@ -670,32 +3907,22 @@ static void do_click(int x, int y, int button) {
     const char *bname = button == BTN_RIGHT ? "right" : button == BTN_MIDDLE ? "middle" : "left";
     fprintf(stderr, "[wlim] %s-clicking at (%d,%d) screen=(%dx%d)\n", bname, x, y, sw, sh);
 
-    /* move to position */
+    /* move, press, release — one frame each. events carry their own
+     * order, so the compositor doesn't need gaps between them. */
     emit(fd, EV_ABS, ABS_X, x);
     emit(fd, EV_ABS, ABS_Y, y);
     emit(fd, EV_SYN, SYN_REPORT, 0);
-    usleep(20000);
-
-    /* press */
     emit(fd, EV_KEY, button, 1);
     emit(fd, EV_SYN, SYN_REPORT, 0);
-    usleep(20000);
-
-    /* release */
     emit(fd, EV_KEY, button, 0);
     emit(fd, EV_SYN, SYN_REPORT, 0);
-    usleep(20000);
-
-    /* destroy */
-    ioctl(fd, UI_DEV_DESTROY);
-    close(fd);
+    pointer.clicked_us = g_get_monotonic_time();
 }
 
 /* ------------------------------------------------------------------ */
 /*  scroll mode — evdev keyboard grab + uinput scroll                  */
 /* ------------------------------------------------------------------ */
 
-#include <signal.h>
 #include <dirent.h>
 #include <linux/input.h>
 
@@ -914,89 +4141,559 @@ static int scroll_main(void) {
 }
 
 /* ------------------------------------------------------------------ */
-/*  hint mode — overlay                                                */
+/*  hint rendering                                                     */
 /* ------------------------------------------------------------------ */
 
-static gboolean strcasestr_match(const char *hay, const char *needle) {
-    if (!needle[0]) return TRUE;
-    size_t nlen = strlen(needle);
-    for (; *hay; hay++) {
-        if (g_ascii_tolower(*hay) == g_ascii_tolower(needle[0]) &&
-            g_ascii_strncasecmp(hay, needle, nlen) == 0)
-            return TRUE;
+/* two renderers behind the same few calls. "labels" is one GtkLabel
+ * per target in a GtkFixed, styled by the .hint-label css. "canvas" is
+ * a single widget that snapshots every hint itself: pango layouts are
+ * cached per label string and each hint's render node is kept until
+ * that hint changes, so GSK's node diff only repaints the hints that
+ * actually changed on a keypress. */
+
+typedef struct {
+    GtkWidget             parent;
+    State                *st;
+    GHashTable           *layouts;  /* "dim_len|label" -> PangoLayout */
+    PangoFontDescription *font;
+    GdkRGBA               bg, fg, dim, border;
+} WlimHints;
+
+typedef struct {
+    GtkWidgetClass parent_class;
+} WlimHintsClass;
+
+G_DEFINE_TYPE(WlimHints, wlim_hints, GTK_TYPE_WIDGET)
+
+/* the layout for a label with its first dim_len chars dimmed */
+static PangoLayout *hints_layout(WlimHints *h, const char *label, int dim_len) {
+    char key[MAX_LABEL + 16];
+    snprintf(key, sizeof(key), "%d|%s", dim_len, label);
+    PangoLayout *l = g_hash_table_lookup(h->layouts, key);
+    if (l) return l;
+
+    l = gtk_widget_create_pango_layout(GTK_WIDGET(h), label);
+    pango_layout_set_font_description(l, h->font);
+    if (dim_len > 0) {
+        PangoAttrList *attrs = pango_attr_list_new();
+        PangoAttribute *a = pango_attr_foreground_new(h->dim.red * 65535,
+                                                      h->dim.green * 65535,
+                                                      h->dim.blue * 65535);
+        a->start_index = 0;
+        a->end_index = dim_len;
+        pango_attr_list_insert(attrs, a);
+        pango_layout_set_attributes(l, attrs);
+        pango_attr_list_unref(attrs);
     }
-    return FALSE;
+    g_hash_table_insert(h->layouts, g_strdup(key), l);
+    return l;
+}
+
+/* one hint box, laid out like the .hint-label css: 1px border, 1px 6px
+ * padding, positioned at the target's label point */
+static GskRenderNode *hints_node(WlimHints *h, const Target *t, int dim_len) {
+    PangoLayout *l = hints_layout(h, t->label, dim_len);
+    int tw, th;
+    pango_layout_get_pixel_size(l, &tw, &th);
+
+    graphene_rect_t box = GRAPHENE_RECT_INIT(t->lx, t->ly, tw + 14, th + 4);
+    GskRoundedRect rr;
+    gsk_rounded_rect_init_from_rect(&rr, &box, cfg.hint_border_radius);
+    const float widths[4] = { 1, 1, 1, 1 };
+    const GdkRGBA colors[4] = { h->border, h->border, h->border, h->border };
+
+    GtkSnapshot *snap = gtk_snapshot_new();
+    gtk_snapshot_push_rounded_clip(snap, &rr);
+    gtk_snapshot_append_color(snap, &h->bg, &box);
+    gtk_snapshot_pop(snap);
+    gtk_snapshot_append_border(snap, &rr, widths, colors);
+    gtk_snapshot_translate(snap, &GRAPHENE_POINT_INIT(t->lx + 7, t->ly + 2));
+    gtk_snapshot_append_layout(snap, l, &h->fg);
+    return gtk_snapshot_free_to_node(snap);
+}
+
+static void wlim_hints_snapshot(GtkWidget *w, GtkSnapshot *snap) {
+    WlimHints *h = (WlimHints *)w;
+    State *s = h->st;
+    for (int i = 0; i < s->ts.n; i++) {
+        if (!s->hint_vis[i]) continue;
+        if (!s->hint_nodes[i])
+            s->hint_nodes[i] = hints_node(h, &s->ts.t[i], s->typed_len);
+        gtk_snapshot_append_node(snap, s->hint_nodes[i]);
+    }
+}
+
+static void wlim_hints_dispose(GObject *obj) {
+    WlimHints *h = (WlimHints *)obj;
+    if (h->layouts) g_hash_table_destroy(h->layouts);
+    h->layouts = NULL;
+    if (h->font) pango_font_description_free(h->font);
+    h->font = NULL;
+    G_OBJECT_CLASS(wlim_hints_parent_class)->dispose(obj);
+}
+
+static void wlim_hints_init(WlimHints *h) {
+    h->layouts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+    h->font = pango_font_description_from_string("monospace bold");
+    pango_font_description_set_absolute_size(h->font, cfg.hint_font_size * PANGO_SCALE);
+    gdk_rgba_parse(&h->bg, cfg.hint_bg);
+    gdk_rgba_parse(&h->fg, cfg.hint_fg);
+    gdk_rgba_parse(&h->dim, cfg.hint_fg_dim);
+    gdk_rgba_parse(&h->border, cfg.hint_border);
+    gtk_widget_set_can_target(GTK_WIDGET(h), FALSE);
+}
+
+static void wlim_hints_class_init(WlimHintsClass *k) {
+    GTK_WIDGET_CLASS(k)->snapshot = wlim_hints_snapshot;
+    G_OBJECT_CLASS(k)->dispose = wlim_hints_dispose;
+}
+
+static GtkWidget *hints_canvas_new(State *s) {
+    WlimHints *h = g_object_new(wlim_hints_get_type(), NULL);
+    h->st = s;
+    gtk_widget_set_hexpand(GTK_WIDGET(h), TRUE);
+    gtk_widget_set_vexpand(GTK_WIDGET(h), TRUE);
+    return GTK_WIDGET(h);
+}
+
+/* show a widget for every target in s->ts from on (all visible) */
+static void hints_put(State *s, int from) {
+    if (s->ts.n > s->hint_cap) {
+        s->hint_cap = s->ts.n;
+        s->hint_labels = g_renew(GtkWidget *, s->hint_labels, s->hint_cap);
+        s->hint_nodes = g_renew(GskRenderNode *, s->hint_nodes, s->hint_cap);
+        s->hint_vis = g_renew(guint8, s->hint_vis, s->hint_cap);
+    }
+    for (int i = from; i < s->ts.n; i++) {
+        s->hint_vis[i] = TRUE;
+        if (cfg.renderer == RENDER_CANVAS) {
+            s->hint_nodes[i] = NULL;
+            continue;
+        }
+        GtkWidget *lbl = gtk_label_new(s->ts.t[i].label);
+        gtk_widget_add_css_class(lbl, "hint-label");
+        gtk_fixed_put(GTK_FIXED(s->fixed), lbl, s->ts.t[i].lx, s->ts.t[i].ly);
+        s->hint_labels[i] = lbl;
+    }
+    if (cfg.renderer == RENDER_CANVAS) gtk_widget_queue_draw(s->canvas);
+}
+
+static void hints_remove(State *s) {
+    for (int i = 0; i < s->ts.n; i++) {
+        if (cfg.renderer == RENDER_CANVAS) {
+            if (s->hint_nodes[i]) gsk_render_node_unref(s->hint_nodes[i]);
+        } else {
+            gtk_fixed_remove(GTK_FIXED(s->fixed), s->hint_labels[i]);
+        }
+    }
+    if (cfg.renderer == RENDER_CANVAS) gtk_widget_queue_draw(s->canvas);
+}
+
+/* show or hide hint i, with the typed prefix of its label dimmed */
+static void hint_update(State *s, int i, gboolean vis) {
+    if (!vis && !s->hint_vis[i]) return;  /* stays hidden, nothing to redraw */
+    s->hint_vis[i] = vis;
+
+    if (cfg.renderer == RENDER_CANVAS) {
+        if (s->hint_nodes[i]) gsk_render_node_unref(s->hint_nodes[i]);
+        s->hint_nodes[i] = NULL;
+        gtk_widget_queue_draw(s->canvas);
+        return;
+    }
+
+    GtkWidget *lbl = s->hint_labels[i];
+    gtk_widget_set_visible(lbl, vis);
+    if (!vis) return;
+    const char *l = s->ts.t[i].label;
+    if (s->typed_len == 0) {
+        gtk_label_set_text(GTK_LABEL(lbl), l);
+        return;
+    }
+    char mk[128], matched[MAX_LABEL+1] = {0};
+    strncpy(matched, l, s->typed_len);
+    snprintf(mk, sizeof(mk),
+        "<span foreground=\"%s\">%s</span>"
+        "<span foreground=\"%s\">%s</span>",
+        cfg.hint_fg_dim, matched,
+        cfg.hint_fg, l + s->typed_len);
+    gtk_label_set_markup(GTK_LABEL(lbl), mk);
+}
+
+/* ------------------------------------------------------------------ */
+/*  search index — fuzzy matching over element names for `/`          */
+/* ------------------------------------------------------------------ */
+
+/* names are lowercased once into one buffer when search starts, with a
+ * per-target mask of the character classes each name contains and a
+ * postings list per class. the first query character takes its
+ * postings list straight away; every further character only re-scores
+ * the previous level's results, since a fuzzy match for "abc" is also
+ * one for "ab". backspace just steps back a level. */
+
+static int search_class(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= '0' && c <= '9') return 26 + c - '0';
+    return 36;
+}
+
+static void search_index_free(SearchIndex *sx) {
+    g_free(sx->folded);
+    g_free(sx->off);
+    g_free(sx->mask);
+    g_free(sx->post);
+    g_free(sx->seen);
+    for (int l = 0; l <= SEARCH_MAX; l++) {
+        g_free(sx->level[l].id);
+        g_free(sx->level[l].score);
+    }
+    memset(sx, 0, sizeof(*sx));
+}
+
+static void search_index_build(SearchIndex *sx, const TargetStore *ts) {
+    search_index_free(sx);
+    sx->n = ts->n;
+    sx->off = g_new(guint32, MAX(ts->n, 1));
+    sx->mask = g_new0(guint64, MAX(ts->n, 1));
+    sx->seen = g_new0(guint32, MAX(ts->n, 1));
+
+    GString *buf = g_string_new(NULL);
+    int count[SEARCH_CLASSES] = {0};
+    for (int i = 0; i < ts->n; i++) {
+        const char *nm = ts_name(ts, i);
+        sx->off[i] = buf->len;
+        for (const char *p = nm; *p; p++) {
+            char c = g_ascii_tolower(*p);
+            g_string_append_c(buf, c);
+            sx->mask[i] |= 1ull << search_class(c);
+        }
+        g_string_append_c(buf, '\0');
+        for (int k = 0; k < SEARCH_CLASSES; k++)
+            if (sx->mask[i] & (1ull << k)) count[k]++;
+    }
+    sx->folded = g_string_free(buf, FALSE);
+
+    /* postings, one packed array indexed by post_start[class] */
+    int total = 0;
+    for (int k = 0; k < SEARCH_CLASSES; k++) {
+        sx->post_start[k] = total;
+        total += count[k];
+    }
+    sx->post_start[SEARCH_CLASSES] = total;
+    sx->post = g_new(int, MAX(total, 1));
+    int fill[SEARCH_CLASSES];
+    memcpy(fill, sx->post_start, sizeof(fill));
+    for (int i = 0; i < ts->n; i++)
+        for (int k = 0; k < SEARCH_CLASSES; k++)
+            if (sx->mask[i] & (1ull << k)) sx->post[fill[k]++] = i;
+
+    sx->built = TRUE;
+}
+
+/* fzf-style scoring: matches score, gaps cost, and matches right after
+ * a word boundary or at a camelCase hump get a bonus, extra on the
+ * first query character */
+enum { CH_WHITE, CH_DELIM, CH_NONWORD, CH_LOWER, CH_UPPER, CH_NUMBER };
+
+#define SC_MATCH         16
+#define SC_GAP_START     (-3)
+#define SC_GAP_EXT       (-1)
+#define BONUS_BOUNDARY   (SC_MATCH / 2)
+#define BONUS_WHITE      (BONUS_BOUNDARY + 2)
+#define BONUS_DELIM      (BONUS_BOUNDARY + 1)
+#define BONUS_NONWORD    (SC_MATCH / 2)
+#define BONUS_CAMEL      (BONUS_BOUNDARY + SC_GAP_EXT)
+#define BONUS_CONSEC     (-(SC_GAP_START + SC_GAP_EXT))
+#define BONUS_FIRST_MULT 2
+
+static int char_kind(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return CH_LOWER;
+    if (c >= 'A' && c <= 'Z') return CH_UPPER;
+    if (c >= '0' && c <= '9') return CH_NUMBER;
+    if (c == ' ' || c == '\t' || c == '\n') return CH_WHITE;
+    if (strchr("/,:;|-_.", c)) return CH_DELIM;
+    if (c >= 0x80) return CH_LOWER;  /* utf-8: treat as letters */
+    return CH_NONWORD;
+}
+
+static int char_bonus(int prev, int cur) {
+    if (cur >= CH_LOWER) {
+        if (prev == CH_WHITE) return BONUS_WHITE;
+        if (prev == CH_DELIM) return BONUS_DELIM;
+        if (prev == CH_NONWORD) return BONUS_BOUNDARY;
+    }
+    if ((prev == CH_LOWER && cur == CH_UPPER) ||
+        (prev != CH_NUMBER && cur == CH_NUMBER))
+        return BONUS_CAMEL;
+    if (cur == CH_NONWORD || cur == CH_DELIM) return BONUS_NONWORD;
+    if (cur == CH_WHITE) return BONUS_WHITE;
+    return 0;
+}
+
+/* score q (lowercase) against a name, -1 if it isn't a subsequence.
+ * like fzf's v1: take the first match going forward, then tighten its
+ * start going backward, then score that window. */
+static int fuzzy_score(const char *folded, const char *orig, const char *q, int qlen) {
+    int sidx = -1, eidx = -1, pi = 0;
+    for (int i = 0; folded[i]; i++) {
+        if (folded[i] != q[pi]) continue;
+        if (sidx < 0) sidx = i;
+        if (++pi == qlen) { eidx = i + 1; break; }
+    }
+    if (eidx < 0) return -1;
+    pi = qlen - 1;
+    for (int i = eidx - 1; i >= sidx; i--)
+        if (folded[i] == q[pi] && --pi < 0) { sidx = i; break; }
+
+    int score = 0, consec = 0, first_bonus = 0;
+    gboolean in_gap = FALSE;
+    int prev = sidx > 0 ? char_kind(orig[sidx - 1]) : CH_WHITE;
+    pi = 0;
+    for (int i = sidx; i < eidx; i++) {
+        int kind = char_kind(orig[i]);
+        if (folded[i] == q[pi]) {
+            int bonus = char_bonus(prev, kind);
+            score += SC_MATCH;
+            if (consec == 0) {
+                first_bonus = bonus;
+            } else {
+                if (bonus >= BONUS_BOUNDARY && bonus > first_bonus) first_bonus = bonus;
+                bonus = MAX(MAX(bonus, first_bonus), BONUS_CONSEC);
+            }
+            score += pi == 0 ? bonus * BONUS_FIRST_MULT : bonus;
+            in_gap = FALSE;
+            consec++;
+            pi++;
+        } else {
+            score += in_gap ? SC_GAP_EXT : SC_GAP_START;
+            in_gap = TRUE;
+            consec = 0;
+            first_bonus = 0;
+        }
+        prev = kind;
+    }
+    return score;
+}
+
+static void search_level_push(SearchLevel *lv, int id, int score) {
+    lv->id[lv->n] = id;
+    lv->score[lv->n] = score;
+    lv->n++;
+}
+
+/* fill level qlen from level qlen-1 (or the postings for qlen 1) */
+static void search_refine(SearchIndex *sx, const TargetStore *ts,
+                          const char *query, int qlen)
+{
+    char q[SEARCH_MAX + 1];
+    guint64 need = 0;
+    for (int k = 0; k < qlen; k++) {
+        q[k] = g_ascii_tolower(query[k]);
+        need |= 1ull << search_class(q[k]);
+    }
+
+    const int *from;
+    int nfrom;
+    if (qlen == 1) {
+        int c = search_class(q[0]);
+        from = sx->post + sx->post_start[c];
+        nfrom = sx->post_start[c + 1] - sx->post_start[c];
+    } else {
+        from = sx->level[qlen - 1].id;
+        nfrom = sx->level[qlen - 1].n;
+    }
+
+    SearchLevel *lv = &sx->level[qlen];
+    lv->id = g_renew(int, lv->id, MAX(nfrom, 1));
+    lv->score = g_renew(int, lv->score, MAX(nfrom, 1));
+    lv->n = 0;
+    for (int k = 0; k < nfrom; k++) {
+        int i = from[k];
+        if ((sx->mask[i] & need) != need) continue;
+        int sc = fuzzy_score(sx->folded + sx->off[i], ts_name(ts, i), q, qlen);
+        if (sc >= 0) search_level_push(lv, i, sc);
+    }
+    sx->depth = qlen;
 }
 
+/* the ids matching the first qlen chars of query, best first */
+static const SearchLevel *search_query(SearchIndex *sx, const TargetStore *ts,
+                                       const char *query, int qlen)
+{
+    if (qlen > SEARCH_MAX) qlen = SEARCH_MAX;
+    if (!sx->built) search_index_build(sx, ts);
+    if (sx->depth > qlen) sx->depth = qlen;
+    while (sx->depth < qlen) search_refine(sx, ts, query, sx->depth + 1);
+    return &sx->level[qlen];
+}
+
+static int search_rank_cmp(const void *a, const void *b, void *data) {
+    const SearchLevel *lv = ((void **)data)[0];
+    const TargetStore *ts = ((void **)data)[1];
+    int ia = *(const int *)a, ib = *(const int *)b;
+    if (lv->score[ia] != lv->score[ib]) return lv->score[ib] - lv->score[ia];
+    /* fzf's tiebreak: shorter names first */
+    size_t la = strlen(ts_name(ts, lv->id[ia])), lb = strlen(ts_name(ts, lv->id[ib]));
+    if (la != lb) return la < lb ? -1 : 1;
+    return lv->id[ia] - lv->id[ib];
+}
+
+/* target ids of a level ordered best match first; caller frees */
+static int *search_ranked(const SearchLevel *lv, const TargetStore *ts) {
+    int *ord = g_new(int, MAX(lv->n, 1));
+    for (int k = 0; k < lv->n; k++) ord[k] = k;
+    const void *ctx[2] = { lv, ts };
+    g_qsort_with_data(ord, lv->n, sizeof(int), search_rank_cmp, ctx);
+    for (int k = 0; k < lv->n; k++) ord[k] = lv->id[ord[k]];
+    return ord;
+}
+
+/* ------------------------------------------------------------------ */
+/*  hint mode — overlay                                                */
+/* ------------------------------------------------------------------ */
+
 static void update_search_box(State *s) {
     char buf[80];
     snprintf(buf, sizeof(buf), "/ %s", s->search);
     gtk_label_set_text(GTK_LABEL(s->search_box), buf);
 }
 
+/* show the targets matching s->search, hide the rest. only the
+ * previous result set and the new one are walked. */
 static void apply_search_filter(State *s) {
-    /* hide hints that don't match search, show those that do */
-    int visible = 0;
-    for (int i = 0; i < s->n_targets; i++) {
-        gboolean match = strcasestr_match(s->targets[i].name, s->search);
-        gtk_widget_set_visible(s->hint_labels[i], match);
-        if (match) visible++;
+    SearchIndex *sx = &s->sx;
+    int qlen = MIN(s->search_len, SEARCH_MAX);
+    if (!sx->built) search_index_build(sx, &s->ts);
+    const SearchLevel *lv = qlen ? search_query(sx, &s->ts, s->search, qlen) : NULL;
+
+    guint32 gen = ++sx->seen_gen;
+    if (lv)
+        for (int k = 0; k < lv->n; k++) sx->seen[lv->id[k]] = gen;
+
+    /* hide what's shown now but didn't match */
+    if (lv && sx->shown > 0) {
+        const SearchLevel *old = &sx->level[sx->shown];
+        for (int k = 0; k < old->n; k++)
+            if (sx->seen[old->id[k]] != gen) hint_update(s, old->id[k], FALSE);
+    } else if (lv) {
+        for (int i = 0; i < s->ts.n; i++)
+            if (sx->seen[i] != gen) hint_update(s, i, FALSE);
+    }
+
+    /* and show the matches */
+    if (lv) {
+        for (int k = 0; k < lv->n; k++)
+            if (!s->hint_vis[lv->id[k]]) hint_update(s, lv->id[k], TRUE);
+    } else {
+        for (int i = 0; i < s->ts.n; i++)
+            if (!s->hint_vis[i]) hint_update(s, i, TRUE);
+    }
+
+    sx->shown = qlen ? qlen : -1;
+    fprintf(stderr, "[wlim] search \"%s\": %d matches\n", s->search,
+            lv ? lv->n : s->ts.n);
+}
+
+/* labels sorted by strcmp put every label sharing a prefix in one
+ * contiguous slice of by_label, so typing a key narrows the current
+ * slice with two binary searches and only the targets that fall out of
+ * it (or whose dimmed prefix grows) get touched. */
+static int label_cmp(const void *a, const void *b, void *data) {
+    const Target *t = data;
+    return strcmp(t[*(const int *)a].label, t[*(const int *)b].label);
+}
+
+static void label_index_build(State *s) {
+    s->by_label = g_renew(int, s->by_label, MAX(s->ts.n, 1));
+    s->nlabeled = 0;
+    for (int i = 0; i < s->ts.n; i++)
+        if (s->ts.t[i].label[0]) s->by_label[s->nlabeled++] = i;
+    g_qsort_with_data(s->by_label, s->nlabeled, sizeof(int), label_cmp, s->ts.t);
+    s->range_lo = 0;
+    s->range_hi = s->nlabeled;
+}
+
+/* the by_label slice whose labels start with prefix[0..len) */
+static void label_range(const State *s, const char *prefix, int len,
+                        int *lo, int *hi)
+{
+    int a = 0, b = s->nlabeled;
+    while (a < b) {   /* first label >= prefix */
+        int m = (a + b) / 2;
+        if (strncmp(s->ts.t[s->by_label[m]].label, prefix, len) < 0) a = m + 1;
+        else b = m;
     }
-    fprintf(stderr, "[wlim] search \"%s\": %d matches\n", s->search, visible);
+    *lo = a;
+    b = s->nlabeled;
+    while (a < b) {   /* first label past the prefix */
+        int m = (a + b) / 2;
+        if (strncmp(s->ts.t[s->by_label[m]].label, prefix, len) <= 0) a = m + 1;
+        else b = m;
+    }
+    *hi = a;
 }
 
 static void relabel_visible(State *s) {
-    /* re-generate short labels for only the visible (filtered) targets */
-    int visible[MAX_TARGETS], nv = 0;
-    for (int i = 0; i < s->n_targets; i++)
-        if (gtk_widget_get_visible(s->hint_labels[i]))
-            visible[nv++] = i;
-
-    /* generate labels for nv items */
-    Target tmp[MAX_TARGETS];
-    for (int i = 0; i < nv; i++) tmp[i] = s->targets[visible[i]];
-    generate_labels(tmp, nv);
-
-    /* clear all labels first */
-    for (int i = 0; i < s->n_targets; i++)
-        s->targets[i].label[0] = '\0';
-
-    /* assign new labels and update widgets */
-    for (int i = 0; i < nv; i++) {
-        int idx = visible[i];
-        strcpy(s->targets[idx].label, tmp[i].label);
-        gtk_label_set_text(GTK_LABEL(s->hint_labels[idx]), tmp[i].label);
-    }
-}
-
-static void update_hints(State *s) {
-    for (int i = 0; i < s->n_targets; i++) {
-        const char *l = s->targets[i].label;
-        if (strncmp(l, s->typed, s->typed_len) == 0) {
-            gtk_widget_set_visible(s->hint_labels[i], TRUE);
-            char mk[128], matched[MAX_LABEL+1] = {0};
-            strncpy(matched, l, s->typed_len);
-            snprintf(mk, sizeof(mk),
-                "<span foreground=\"%s\">%s</span>"
-                "<span foreground=\"%s\">%s</span>",
-                cfg.hint_fg_dim, matched,
-                cfg.hint_fg, l + s->typed_len);
-            gtk_label_set_markup(GTK_LABEL(s->hint_labels[i]), mk);
-        } else {
-            gtk_widget_set_visible(s->hint_labels[i], FALSE);
-        }
+    /* re-generate short labels for only the visible (filtered) targets,
+     * best search match first */
+    int *order, nv = 0;
+    if (s->sx.built && s->sx.shown > 0) {
+        const SearchLevel *lv = &s->sx.level[s->sx.shown];
+        order = search_ranked(lv, &s->ts);
+        nv = lv->n;
+    } else {
+        order = g_new(int, MAX(s->ts.n, 1));
+        for (int i = 0; i < s->ts.n; i++)
+            if (s->hint_vis[i]) order[nv++] = i;
+    }
+
+    /* search results are weighted by rank, zipf-style */
+    double *w = NULL;
+    if (s->sx.built && s->sx.shown > 0) {
+        w = g_new(double, MAX(nv, 1));
+        for (int k = 0; k < nv; k++) w[k] = 1.0 / (k + 1);
     }
+
+    for (int i = 0; i < s->ts.n; i++)
+        if (!s->hint_vis[i]) s->ts.t[i].label[0] = '\0';
+    assign_labels(s->ts.t, order, w, nv);
+    for (int k = 0; k < nv; k++) hint_update(s, order[k], TRUE);
+    g_free(order);
+    g_free(w);
+    label_index_build(s);
 }
 
-static gboolean on_key(GtkEventControllerKey *ctrl, guint keyval,
-                        guint keycode, GdkModifierType mod, gpointer data)
+/* move the visible slice to whatever matches s->typed. returns FALSE
+ * (and changes nothing) if no label starts with it. */
+static gboolean update_hints(State *s) {
+    int lo, hi;
+    label_range(s, s->typed, s->typed_len, &lo, &hi);
+    if (lo == hi) return FALSE;
+
+    /* hide what was shown but no longer matches */
+    for (int k = s->range_lo; k < MIN(s->range_hi, lo); k++)
+        hint_update(s, s->by_label[k], FALSE);
+    for (int k = MAX(s->range_lo, hi); k < s->range_hi; k++)
+        hint_update(s, s->by_label[k], FALSE);
+    /* the rest shows the new typed prefix dimmed */
+    for (int k = lo; k < hi; k++)
+        hint_update(s, s->by_label[k], TRUE);
+
+    s->range_lo = lo;
+    s->range_hi = hi;
+    return TRUE;
+}
+
+static void overlay_finish(State *s);
+static void collect_flush(State *s);
+
+static gboolean handle_key(GtkEventControllerKey *ctrl, guint keyval,
+                           guint keycode, GdkModifierType mod, State *s)
 {
-    State *s = data;
     const char *kn = gdk_keyval_name(keyval);
 
     if (g_strcmp0(kn, "Escape") == 0) {
         s->should_click = FALSE;
-        g_application_quit(G_APPLICATION(s->app));
+        overlay_finish(s);
         return TRUE;
     }
 
@@ -1005,6 +4702,7 @@ static gboolean on_key(GtkEventControllerKey *ctrl, guint keyval,
         s->search_mode = TRUE;
         s->search_len = 0;
         s->search[0] = '\0';
+        s->sx.shown = -1;
         gtk_widget_set_visible(s->search_box, TRUE);
         update_search_box(s);
         return TRUE;
@@ -1015,9 +4713,10 @@ static gboolean on_key(GtkEventControllerKey *ctrl, guint keyval,
         if (g_strcmp0(kn, "Return") == 0) {
             s->search_mode = FALSE;
             gtk_widget_set_visible(s->search_box, FALSE);
-            relabel_visible(s);
+            if (s->search_len == 0) return TRUE;  /* nothing searched, labels stay */
             s->typed_len = 0;
             s->typed[0] = '\0';
+            relabel_visible(s);
             return TRUE;
         }
         if (g_strcmp0(kn, "BackSpace") == 0) {
@@ -1025,6 +4724,7 @@ static gboolean on_key(GtkEventControllerKey *ctrl, guint keyval,
                 s->search[--s->search_len] = '\0';
                 apply_search_filter(s);
                 update_search_box(s);
+                if (s->search_len == 0) collect_flush(s);
             }
             return TRUE;
         }
@@ -1043,42 +4743,64 @@ static gboolean on_key(GtkEventControllerKey *ctrl, guint keyval,
         if (s->typed_len > 0) { s->typed[--s->typed_len] = '\0'; update_hints(s); }
         return TRUE;
     }
+    /* take the key's unshifted meaning in the current layout, so that
+     * shift+; still types ; (and right-clicks) */
+    guint base = keyval;
+    GdkEvent *ev = gtk_event_controller_get_current_event(GTK_EVENT_CONTROLLER(ctrl));
+    if (ev)
+        gdk_display_translate_key(gtk_widget_get_display(s->win), keycode, 0,
+                                  gdk_key_event_get_layout(ev), &base, NULL, NULL, NULL);
     char ch = 0;
-    if (keyval >= 'a' && keyval <= 'z') ch = (char)keyval;
-    else if (keyval >= 'A' && keyval <= 'Z') ch = (char)(keyval + 32);
+    if (base >= 0x20 && base <= 0x7e && hint.key[(guchar)g_ascii_tolower((char)base)])
+        ch = g_ascii_tolower((char)base);
     if (!ch || s->typed_len >= MAX_TYPED) return TRUE;
 
     s->typed[s->typed_len++] = ch;
     s->typed[s->typed_len] = '\0';
-    update_hints(s);
+    if (!update_hints(s)) {
+        /* nothing starts with that, start over */
+        s->typed_len = 0;
+        s->typed[0] = '\0';
+        update_hints(s);
+        return TRUE;
+    }
 
-    int mi = -1, mc = 0;
-    for (int i = 0; i < s->n_targets; i++)
-        if (strcmp(s->targets[i].label, s->typed) == 0) { mi = i; mc++; }
-    if (mc == 1) {
+    /* labels are unique, so an exact match sorts first in the slice */
+    int mi = s->by_label[s->range_lo];
+    if (strcmp(s->ts.t[mi].label, s->typed) == 0) {
+        history_note(s->ts.t[mi].hkey);
         s->should_click = TRUE;
-        s->click_x = s->targets[mi].cx;
-        s->click_y = s->targets[mi].cy;
+        s->click_x = s->ts.t[mi].cx;
+        s->click_y = s->ts.t[mi].cy;
         s->click_button = (mod & GDK_SHIFT_MASK) ? BTN_RIGHT
                         : (mod & GDK_CONTROL_MASK) ? BTN_MIDDLE
                         : BTN_LEFT;
-        gtk_window_destroy(GTK_WINDOW(s->win));
+        overlay_finish(s);
         return TRUE;
     }
 
-    int any = 0;
-    for (int i = 0; i < s->n_targets; i++)
-        if (strncmp(s->targets[i].label, s->typed, s->typed_len) == 0) any++;
-    if (!any) { s->typed_len = 0; s->typed[0] = '\0'; update_hints(s); }
-
     return TRUE;
 }
 
-static void on_activate(GtkApplication *app, gpointer data) {
-    State *s = data;
-    s->app = app;
-    GtkWidget *win = gtk_application_window_new(app);
+static gboolean on_key(GtkEventControllerKey *ctrl, guint keyval,
+                       guint keycode, GdkModifierType mod, gpointer data)
+{
+    gint64 t0 = g_get_monotonic_time();
+    gboolean handled = handle_key(ctrl, keyval, keycode, mod, data);
+    stats.keys++;
+    stats.keys_us += g_get_monotonic_time() - t0;
+    return handled;
+}
+
+/* build the layer-shell window, css and key handling. the hint labels
+ * themselves are added separately by overlay_populate() so the daemon
+ * can keep this window around between triggers. */
+static void on_overlay_unmap(GtkWidget *w, gpointer data);
+
+static void overlay_build(State *s) {
+    GtkWidget *win = gtk_application_window_new(s->app);
     s->win = win;
+    hint_init(gtk_widget_get_display(win));
 
     gtk_layer_init_for_window(GTK_WINDOW(win));
     gtk_layer_set_layer(GTK_WINDOW(win), GTK_LAYER_SHELL_LAYER_OVERLAY);
@@ -1125,15 +4847,13 @@ static void on_activate(GtkApplication *app, gpointer data) {
     GtkWidget *overlay = gtk_overlay_new();
     gtk_window_set_child(GTK_WINDOW(win), overlay);
 
-    GtkWidget *fixed = gtk_fixed_new();
-    gtk_overlay_set_child(GTK_OVERLAY(overlay), fixed);
-    s->fixed = fixed;
-
-    for (int i = 0; i < s->n_targets; i++) {
-        GtkWidget *lbl = gtk_label_new(s->targets[i].label);
-        gtk_widget_add_css_class(lbl, "hint-label");
-        gtk_fixed_put(GTK_FIXED(fixed), lbl, s->targets[i].lx, s->targets[i].ly);
-        s->hint_labels[i] = lbl;
+    if (cfg.renderer == RENDER_CANVAS) {
+        s->canvas = hints_canvas_new(s);
+        gtk_overlay_set_child(GTK_OVERLAY(overlay), s->canvas);
+    } else {
+        GtkWidget *fixed = gtk_fixed_new();
+        gtk_overlay_set_child(GTK_OVERLAY(overlay), fixed);
+        s->fixed = fixed;
     }
 
     /* search box — centered at bottom, hidden by default */
@@ -1148,15 +4868,1039 @@ static void on_activate(GtkApplication *app, gpointer data) {
     GtkEventController *kc = gtk_event_controller_key_new();
     g_signal_connect(kc, "key-pressed", G_CALLBACK(on_key), s);
     gtk_widget_add_controller(win, kc);
-    gtk_window_present(GTK_WINDOW(win));
+
+    g_signal_connect(win, "unmap", G_CALLBACK(on_overlay_unmap), s);
+}
+
+/* put up hints for targets from on, and keep the slice on what's
+ * typed: the new ones that don't start with it stay hidden */
+static void overlay_populate(State *s, int from) {
+    hints_put(s, from);
+    label_index_build(s);
+    if (s->typed_len == 0) return;
+
+    int lo, hi;
+    label_range(s, s->typed, s->typed_len, &lo, &hi);
+    if (lo == hi) {
+        /* only after a rebuild (from = 0, all up): start over */
+        s->typed_len = 0;
+        s->typed[0] = '\0';
+        return;
+    }
+    for (int i = from; i < s->ts.n; i++)
+        hint_update(s, i, strncmp(s->ts.t[i].label, s->typed, s->typed_len) == 0);
+    s->range_lo = lo;
+    s->range_hi = hi;
+}
+
+static void overlay_clear(State *s) {
+    if (!s->headless) hints_remove(s);
+    search_index_free(&s->sx);
+    ts_reset(&s->ts);
+}
+
+static void collect_resume(void);
+
+/* first painted frame after present — report trigger-to-first-frame */
+static void on_first_paint(GdkFrameClock *clock, gpointer data) {
+    State *s = data;
+    s->shown_us = g_get_monotonic_time();
+    stats_mark(PHASE_FIRST_FRAME);
+    fprintf(stderr, "[wlim] trigger-to-first-frame: %.1f ms\n",
+            (s->shown_us - s->trigger_us) / 1000.0);
+    g_signal_handler_disconnect(clock, s->paint_handler);
+    s->paint_handler = 0;
+    collect_resume();
+}
+
+static void overlay_present(State *s) {
+    s->active = TRUE;
+    gtk_window_present(GTK_WINDOW(s->win));
+    GdkFrameClock *clock = gtk_widget_get_frame_clock(s->win);
+    if (clock && !s->paint_handler)
+        s->paint_handler = g_signal_connect(clock, "after-paint",
+                                            G_CALLBACK(on_first_paint), s);
+}
+
+static void collect_begin(State *st);
+
+static void on_activate(GtkApplication *app, gpointer data) {
+    State *s = data;
+    s->app = app;
+    overlay_build(s);
+    stats_mark(PHASE_OVERLAY);
+    collect_begin(s);
+}
+
+/* click the chosen target and break down where the time went */
+static void click_chosen(State *s) {
+    gint64 t0 = g_get_monotonic_time();
+    do_click(s->click_x, s->click_y, s->click_button);
+    gint64 t1 = g_get_monotonic_time();
+    stats.click_us = t1 - t0;
+    gint64 shown = s->shown_us ? s->shown_us : s->trigger_us;
+    gint64 unmapped = s->unmapped_us ? s->unmapped_us : s->chosen_us;
+    gint64 synced = s->synced_us ? s->synced_us : unmapped;
+    fprintf(stderr, "[wlim] timing: trigger->frame %.1f, frame->choice %.1f, "
+            "choice->unmap %.1f, unmap->sync %.1f, sync->click %.1f, "
+            "click %.1f, total %.1f ms\n",
+            (shown - s->trigger_us) / 1000.0,
+            (s->chosen_us - shown) / 1000.0,
+            (unmapped - s->chosen_us) / 1000.0,
+            (synced - unmapped) / 1000.0,
+            (t0 - synced) / 1000.0,
+            (t1 - t0) / 1000.0,
+            (t1 - s->trigger_us) / 1000.0);
+}
+
+/* the click must land after the compositor has dropped the overlay,
+ * or it hits the overlay instead of the target. instead of sleeping a
+ * fixed 150ms, wait for the window's unmap, then a display roundtrip:
+ * once that returns the compositor has processed the unmap commit.
+ * the timeout is only a safety net if the unmap never comes. */
+#define CLICK_FALLBACK_MS 300
+
+static void click_fire(State *s) {
+    if (!s->click_pending) return;
+    s->click_pending = FALSE;
+    if (s->click_timeout) g_source_remove(s->click_timeout);
+    s->click_timeout = 0;
+
+    click_chosen(s);
+    stats_mark(PHASE_CLICKED);
+    stats_emit();
+    if (!s->daemon) g_application_quit(G_APPLICATION(s->app));
+}
+
+static gboolean click_after_unmap(gpointer data) {
+    State *s = data;
+    if (!s->click_pending) return G_SOURCE_REMOVE;
+    gdk_display_sync(gtk_widget_get_display(s->win));
+    s->synced_us = g_get_monotonic_time();
+    fprintf(stderr, "[wlim] overlay gone %.1f ms after choice (was a fixed 150 ms)\n",
+            (s->synced_us - s->chosen_us) / 1000.0);
+    click_fire(s);
+    return G_SOURCE_REMOVE;
+}
+
+static void on_overlay_unmap(GtkWidget *w, gpointer data) {
+    (void)w;
+    State *s = data;
+    if (!s->click_pending || s->unmapped_us) return;
+    s->unmapped_us = g_get_monotonic_time();
+    /* let GTK finish the unmap commit before the roundtrip */
+    g_idle_add(click_after_unmap, s);
 }
 
-static void on_shutdown(GtkApplication *app, gpointer data) {
+static gboolean on_click_fallback(gpointer data) {
     State *s = data;
+    s->click_timeout = 0;
+    fprintf(stderr, "[wlim] no unmap after %d ms, clicking anyway\n", CLICK_FALLBACK_MS);
+    click_fire(s);
+    return G_SOURCE_REMOVE;
+}
+
+/* arm the click for when the overlay goes away */
+static void click_schedule(State *s) {
+    s->click_pending = TRUE;
+    s->unmapped_us = 0;
+    s->synced_us = 0;
+    s->click_timeout = g_timeout_add(CLICK_FALLBACK_MS, on_click_fallback, s);
+}
+
+/* ------------------------------------------------------------------ */
+/*  slow apps — over their walk budget, remembered across runs         */
+/* ------------------------------------------------------------------ */
+
+/* an app that went over cfg.app_budget is walked after all the others
+ * next time. do it twice in a row and it's left out for SLOW_RETRY_S,
+ * then given another go; the focused app is always walked. kept in
+ * $XDG_STATE_HOME/wlim/slow so one-shot runs know about them too. */
+#define SLOW_SKIP_STRIKES 2
+#define SLOW_RETRY_S      60
+#define SLOW_FORGET_S     3600  /* pids get reused */
+
+typedef struct { int strikes; gint64 last; } SlowApp;  /* last: unix time */
+
+static GHashTable *slow_apps;  /* pid -> SlowApp */
+
+static gboolean slow_path(char *buf, size_t sz) {
+    const char *xdg = getenv("XDG_STATE_HOME");
+    const char *home = getenv("HOME");
+    char dir[512];
+    if (xdg && xdg[0])
+        snprintf(dir, sizeof(dir), "%s/wlim", xdg);
+    else if (home)
+        snprintf(dir, sizeof(dir), "%s/.local/state/wlim", home);
+    else
+        return FALSE;
+    g_mkdir_with_parents(dir, 0700);
+    snprintf(buf, sz, "%s/slow", dir);
+    return TRUE;
+}
+
+static void slow_load(void) {
+    if (slow_apps) return;
+    slow_apps = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+    char path[560];
+    gchar *data;
+    if (!slow_path(path, sizeof(path)) || !g_file_get_contents(path, &data, NULL, NULL))
+        return;
+    time_t now = time(NULL);
+    char *save;
+    for (char *line = strtok_r(data, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        int pid, strikes;
+        long long last;
+        if (sscanf(line, "%d %d %lld", &pid, &strikes, &last) != 3 || pid <= 0 ||
+            strikes <= 0 || now - last > SLOW_FORGET_S)
+            continue;
+        SlowApp *sa = g_new(SlowApp, 1);
+        sa->strikes = strikes;
+        sa->last = last;
+        g_hash_table_replace(slow_apps, GINT_TO_POINTER(pid), sa);
+    }
+    g_free(data);
+}
+
+static void slow_save(void) {
+    char path[560];
+    if (!slow_path(path, sizeof(path))) return;
+    GString *o = g_string_new(NULL);
+    GHashTableIter it;
+    gpointer key, val;
+    g_hash_table_iter_init(&it, slow_apps);
+    while (g_hash_table_iter_next(&it, &key, &val)) {
+        const SlowApp *sa = val;
+        g_string_append_printf(o, "%d %d %lld\n", GPOINTER_TO_INT(key),
+                               sa->strikes, (long long)sa->last);
+    }
+    g_file_set_contents(path, o->str, o->len, NULL);
+    g_string_free(o, TRUE);
+}
+
+static const SlowApp *slow_app(int pid) {
+    if (pid <= 0) return NULL;
+    slow_load();
+    return g_hash_table_lookup(slow_apps, GINT_TO_POINTER(pid));
+}
+
+static gboolean slow_skip(int pid) {
+    const SlowApp *sa = slow_app(pid);
+    return sa && sa->strikes >= SLOW_SKIP_STRIKES && time(NULL) - sa->last < SLOW_RETRY_S;
+}
+
+/* remember how walking r's app went */
+static void slow_note(const AppResult *r) {
+    if (r->pid <= 0) return;
+    slow_load();
+    gpointer key = GINT_TO_POINTER(r->pid);
+    if (!r->slow) {
+        if (g_hash_table_remove(slow_apps, key)) slow_save();
+        return;
+    }
+
+    SlowApp *sa = g_hash_table_lookup(slow_apps, key);
+    if (!sa) {
+        sa = g_new0(SlowApp, 1);
+        g_hash_table_insert(slow_apps, key, sa);
+    }
+    sa->strikes++;
+    sa->last = time(NULL);
+    slow_save();
+
+    const HyprClient *hc = hypr_client_by_pid(hypr_clients(), r->pid);
+    fprintf(stderr, "[wlim] app %d (%s) went over its %d ms budget, skipped (%d in a row)\n",
+            r->pid, hc && hc->cls ? hc->cls : "?", cfg.app_budget, sa->strikes);
+}
+
+/* ------------------------------------------------------------------ */
+/*  progressive collection — focused window first, the rest streamed   */
+/* ------------------------------------------------------------------ */
+
+/* the focused window is walked synchronously and shown right away.
+ * every other app is then walked in the background (by the pool, or
+ * one app per idle callback) and merged into the overlay as it comes,
+ * as long as the user isn't searching. */
+typedef struct {
+    State            *st;
+    guint             gen;
+    gboolean          running;
+    AtspiAccessible  *desktop;
+    AtspiAccessible **apps;
+    AppResult        *res;
+    int               napps;
+    int              *order;      /* app indices, slow apps last */
+    int               next;       /* next of order to hand out */
+    int               pending;    /* apps not finished yet */
+    int               focus_app;  /* desktop index, -1 if unknown */
+    int               focus_win;  /* window index inside focus_app */
+    int               cursor_x, cursor_y;  /* -1 if unknown */
+    int               active_pid;          /* hyprland's focused window */
+    char              active_title[256];
+    AppResult         focus;
+    TargetStore       snap;       /* focused window's snapshot */
+    gboolean          snap_live;  /* shown in place of focus until it's walked */
+    gboolean          shown;      /* overlay holds this collection */
+    gboolean          shown_snap; /* ... with the snapshot in it */
+    gboolean          late;       /* apps held back by a search */
+    guint             resume_id;  /* walk after the snapshot is painted */
+    guint             idle_id;
+} Collect;
+
+static Collect coll;
+
+static void collect_free(Collect *c) {
+    c->running = FALSE;
+    c->snap_live = FALSE;
+    if (c->idle_id) g_source_remove(c->idle_id);
+    c->idle_id = 0;
+    if (c->resume_id) g_source_remove(c->resume_id);
+    c->resume_id = 0;
+    for (int i = 0; i < c->napps; i++) {
+        app_result_clear(&c->res[i]);
+        if (c->apps[i]) g_object_unref(c->apps[i]);
+    }
+    app_result_clear(&c->focus);
+    g_free(c->res);
+    g_free(c->apps);
+    g_free(c->order);
+    c->res = NULL;
+    c->apps = NULL;
+    c->order = NULL;
+    c->napps = 0;
+    if (c->desktop) g_object_unref(c->desktop);
+    c->desktop = NULL;
+}
+
+/* stop a collection early, e.g. because the overlay was closed.
+ * workers still busy with it finish their job and get ignored. */
+static void collect_cancel(void) {
+    if (!coll.running) return;
+    coll.gen++;
+    collect_free(&coll);
+}
+
+/* targets of ts that have no label yet go into tg, with their weights */
+static void collect_gather(Collect *c, TargetStore *ts, gboolean focused,
+                           GPtrArray *tg, GArray *w, double *wsum)
+{
+    for (int i = 0; i < ts->n; i++) {
+        Target *t = &ts->t[i];
+        if (t->label[0] || (focused && labels_pin(c->st, ts, i))) continue;
+        double wt = target_weight(t, focused, c->cursor_x, c->cursor_y);
+        g_ptr_array_add(tg, t);
+        g_array_append_val(w, wt);
+        *wsum += wt;
+    }
+}
+
+/* label what has come in since the last show, where it came in. labels
+ * on screen never change: a key typed just as an app arrives still
+ * means what the overlay said. the newcomers get what's left of the
+ * code space, and while apps are still out, room is kept for about as
+ * many targets per app as have turned up so far. */
+static void collect_label(Collect *c) {
+    State *st = c->st;
+    GPtrArray *tg = g_ptr_array_new();
+    GArray *w = g_array_new(FALSE, FALSE, sizeof(double));
+    double wsum = 0;
+    int have = 0, ndone = 1;
+
+    if (c->snap_live) {
+        collect_gather(c, &c->snap, TRUE, tg, w, &wsum);
+        have += c->snap.n;
+    } else {
+        for (int k = 0; k < c->focus.nwins; k++) {
+            collect_gather(c, &c->focus.wins[k].ts, TRUE, tg, w, &wsum);
+            have += c->focus.wins[k].ts.n;
+        }
+    }
+    gboolean focused = tg->len > 0;
+    for (int i = 0; i < c->napps; i++) {
+        if (!c->res[i].done) continue;
+        ndone++;
+        for (int k = 0; k < c->res[i].nwins; k++) {
+            collect_gather(c, &c->res[i].wins[k].ts, FALSE, tg, w, &wsum);
+            have += c->res[i].wins[k].ts.n;
+        }
+    }
+
+    int n = tg->len;
+    if (n > 0) {
+        int more = c->pending + (c->snap_live ? 1 : 0);
+        int spare = labels_spare(have, ndone, more);
+        double spare_w = wsum / n / (focused && ndone == 1 ? FOCUS_BOOST : 1.0);
+        int missing = labels_add(st->label_space, (Target **)tg->pdata,
+                                 (const double *)(const void *)w->data, n, spare, spare_w);
+        if (missing > st->label_missing) labels_warn_missing(missing);
+        st->label_missing = missing;
+    }
+    g_ptr_array_free(tg, TRUE);
+    g_array_free(w, TRUE);
+}
+
+/* put what has come in since the last show on the overlay. the first
+ * show, and the one where the focused window's walk replaces its
+ * snapshot, start afresh; after that only the new apps' hints are
+ * added and the ones up stay as they are, narrowed to what's typed.
+ * while a search filters the hints, apps wait (c->late) until it's
+ * cleared, see collect_flush(). */
+static void collect_show(Collect *c) {
+    State *st = c->st;
+    if (st->active && st->search_len > 0) {
+        c->late = TRUE;
+        return;
+    }
+    c->late = FALSE;
+
+    gint64 t0 = g_get_monotonic_time();
+    collect_label(c);
+    stats.labels_us += g_get_monotonic_time() - t0;
+
+    int from = st->ts.n;
+    if (!c->shown || c->shown_snap != c->snap_live) {
+        overlay_clear(st);
+        from = 0;
+        if (c->snap_live) ts_append(&st->ts, &c->snap, 0, c->snap.n);
+        else merge_result(&st->ts, &c->focus);
+        st->nfocus = st->ts.n;
+        for (int i = 0; i < c->napps; i++) c->res[i].shown = FALSE;
+        c->shown = TRUE;
+        c->shown_snap = c->snap_live;
+    }
+    for (int i = 0; i < c->napps; i++) {
+        if (!c->res[i].done || c->res[i].shown) continue;
+        merge_result(&st->ts, &c->res[i]);
+        c->res[i].shown = TRUE;
+    }
+    if (st->ts.n == from) return;
+    search_index_free(&st->sx);  /* / builds it again over the lot */
+
+    gint64 t1 = g_get_monotonic_time();
+    stats.targets = st->ts.n;
+    if (st->headless) return;
+    overlay_populate(st, from);
+    stats.render_us += g_get_monotonic_time() - t1;
+    if (!st->active) overlay_present(st);
+}
+
+/* a search held apps back and is cleared now: show them. once the
+ * collection is over they wait in st->late, complete. */
+static void collect_flush(State *s) {
+    Collect *c = &coll;
+    if (c->running && c->st == s) {
+        if (c->late) collect_show(c);
+        return;
+    }
+    if (s->late.n == 0) return;
+    overlay_clear(s);
+    ts_append(&s->ts, &s->late, 0, s->late.n);
+    s->nfocus = s->late_nfocus;
+    ts_reset(&s->late);
+    stats.targets = s->ts.n;
+    overlay_populate(s, 0);
+}
+
+/* --dump: a JSON line per target of one app's windows */
+static void dump_result(const AppResult *r, gboolean focused) {
+    static const char *const corrections[] = { "none", "offset", "grid" };
+    GString *o = g_string_new(NULL);
+    for (int k = 0; k < r->nwins; k++) {
+        const WinResult *wr = &r->wins[k];
+        for (int i = 0; i < wr->ts.n; i++) {
+            const Target *t = &wr->ts.t[i];
+            gchar *role = atspi_role_get_name(t->role);
+            g_string_truncate(o, 0);
+            g_string_append(o, "{\"label\":");
+            json_str(o, t->label);
+            g_string_append(o, ",\"name\":");
+            json_str(o, ts_name(&wr->ts, i));
+            g_string_append(o, ",\"role\":");
+            json_str(o, role);
+            g_string_append_printf(o, ",\"pid\":%d,\"window\":", r->pid);
+            json_str(o, wr->title);
+            g_string_append_printf(o,
+                ",\"focused\":%s,\"bounds\":[%d,%d,%d,%d],\"click\":[%d,%d],"
+                "\"label_at\":[%d,%d],\"correction\":\"%s\"}",
+                focused ? "true" : "false", t->x, t->y, t->w, t->h,
+                t->cx, t->cy, t->lx, t->ly, corrections[wr->correction]);
+            puts(o->str);
+            g_free(role);
+        }
+    }
+    g_string_free(o, TRUE);
+}
+
+static void collect_finish(Collect *c) {
+    State *st = c->st;
+    fprintf(stderr, "[wlim] collection done: %d targets\n", st->ts.n);
+    stats_mark(PHASE_COLLECTED);
+    if (c->snap_live) {
+        /* the focused window was never walked after all */
+        c->snap_live = FALSE;
+        collect_show(c);
+    }
+    if (st->dump) {
+        dump_result(&c->focus, TRUE);
+        for (int i = 0; i < c->napps; i++)
+            if (c->res[i].done) dump_result(&c->res[i], FALSE);
+        fflush(stdout);
+    }
+    if (c->late) {
+        /* the search is still on; keep all of it for collect_flush() */
+        ts_reset(&st->late);
+        merge_result(&st->late, &c->focus);
+        st->late_nfocus = st->late.n;
+        for (int i = 0; i < c->napps; i++)
+            if (c->res[i].done) merge_result(&st->late, &c->res[i]);
+    }
+    collect_free(c);
+    if (win_caches) cache_sweep();
+
+    if (st->ts.n == 0 && !st->headless) {
+        stats_emit();
+        system("notify-send -t 3000 wlim 'no clickable elements found'");
+        if (!st->daemon) g_application_quit(G_APPLICATION(st->app));
+    }
+}
+
+static void collect_app_done(Collect *c, int i) {
+    slow_note(&c->res[i]);
+    correct_result(&c->res[i], hypr_clients());
+    stats_app(&c->res[i]);
+    gboolean replaces_snap = c->snap_live && c->res[i].pid == c->active_pid;
+    if (replaces_snap) c->snap_live = FALSE;
+    c->pending--;
+    if (c->res[i].nwins > 0 || replaces_snap) collect_show(c);
+    snapshot_save(&c->res[i]);
+    if (c->pending == 0) collect_finish(c);
+}
+
+static gboolean collect_idle_step(gpointer data) {
+    Collect *c = data;
+    while (c->next < c->napps && c->res[c->order[c->next]].pid <= 0) c->next++;
+    if (c->next >= c->napps) {
+        c->idle_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    int i = c->order[c->next++];
+    walk_app(c->apps[i], &c->res[i], i == c->focus_app ? c->focus_win : -1);
+    collect_app_done(c, i);
+
+    /* collect_finish() has already dropped this source if we're done */
+    if (!c->running) return G_SOURCE_REMOVE;
+    return G_SOURCE_CONTINUE;
+}
+
+/* give the next app to worker w, if there is one */
+static void collect_dispatch(Collect *c, int w) {
+    while (c->next < c->napps && c->res[c->order[c->next]].pid <= 0) c->next++;
+    if (c->next >= c->napps) return;
+
+    int i = c->order[c->next++];
+    if (pool_send(w, i, c->res[i].pid, i == c->focus_app ? c->focus_win : -1, c->gen)) {
+        pool[w].gen = c->gen;
+    } else {
+        walk_app(c->apps[i], &c->res[i], i == c->focus_app ? c->focus_win : -1);
+        collect_app_done(c, i);
+    }
+}
+
+static gboolean on_pool_msg(gint fd, GIOCondition cond, gpointer data) {
+    Collect *c = &coll;
+    int w = pool_find(fd);
+    if (w < 0) return G_SOURCE_REMOVE;
+
+    int job = pool[w].job;
+    gboolean mine = c->running && job >= 0 && pool[w].gen == c->gen;
+    AppResult stale = {0};
+    AppResult *r = mine ? &c->res[job] : &stale;
+
+    int rc = pool_recv(w, r);
+    app_result_clear(&stale);
+    if (rc == 0) return G_SOURCE_CONTINUE;
+
+    if (rc < 0) {
+        if (mine) {
+            walk_app(c->apps[job], r, job == c->focus_app ? c->focus_win : -1);
+            collect_app_done(c, job);
+        }
+        return G_SOURCE_REMOVE;
+    }
+
+    if (mine) {
+        if (!r->done && !r->slow)
+            walk_app(c->apps[job], r, job == c->focus_app ? c->focus_win : -1);
+        collect_app_done(c, job);
+    }
+    if (c->running) collect_dispatch(c, w);
+    return G_SOURCE_CONTINUE;
+}
+
+/* find and walk the hyprland-focused window. returns FALSE if it
+ * can't be matched to an AT-SPI window. */
+static gboolean collect_focus(Collect *c) {
+    int apid = c->active_pid;
+    const char *atitle = c->active_title;
+    if (apid <= 0) return FALSE;
+
+    for (int i = 0; i < c->napps && c->focus_app < 0; i++)
+        if (c->res[i].pid == apid) c->focus_app = i;
+    if (c->focus_app < 0) return FALSE;
+
+    AtspiAccessible *app = c->apps[c->focus_app];
+    c->focus_win = focus_window(app, atitle);
+    if (c->focus_win < 0) return FALSE;
+
+    AtspiAccessible *w = atspi_accessible_get_child_at_index(app, c->focus_win, NULL);
+    if (!w) return FALSE;
+    c->focus.pid = apid;
+    walk_budget_start();
+    walk_app_window(w, &c->focus);
+    g_object_unref(w);
+    gboolean slow = walk_over_budget();
+    walk_deadline = 0;
+    if (slow) {
+        /* don't spend another budget on its other windows */
+        app_result_clear(&c->focus);
+        c->focus.slow = TRUE;
+        slow_note(&c->focus);
+        c->res[c->focus_app].pid = 0;
+        c->pending--;
+        return FALSE;
+    }
+    correct_result(&c->focus, hypr_clients());
+    stats_app(&c->focus);
+    return TRUE;
+}
+
+static void collect_walk(Collect *c);
+
+/* with a snapshot up, the walk waits for its first frame, or this long */
+#define SNAPSHOT_PAINT_MS 50
+
+static gboolean collect_resume_cb(gpointer data) {
+    Collect *c = data;
+    c->resume_id = 0;
+    collect_walk(c);
+    return G_SOURCE_REMOVE;
+}
+
+/* the snapshot is on screen; walk as soon as the frame handler is done */
+static void collect_resume(void) {
+    if (!coll.running || !coll.resume_id) return;
+    g_source_remove(coll.resume_id);
+    coll.resume_id = g_idle_add(collect_resume_cb, &coll);
+}
+
+static void collect_begin(State *st) {
+    Collect *c = &coll;
+    collect_cancel();
+
+    memset(&c->focus, 0, sizeof(c->focus));
+    c->st = st;
+    c->gen++;
+    c->running = TRUE;
+    c->focus_app = -1;
+    c->focus_win = -1;
+    c->next = 0;
+    c->pending = 0;
+    c->shown = FALSE;
+    c->late = FALSE;
+    ts_reset(&st->late);
+
+    if (win_caches) {
+        cache_round++;
+        cache_resolve_orphans();
+    }
+    items_apps_drop();
+
+    /* the pointer is asked for while the client table is on its way */
+    hypr_begin();
+    c->cursor_x = c->cursor_y = -1;
+    if (cfg.labels == LABELS_WEIGHTED && !hypr_cursor(&c->cursor_x, &c->cursor_y))
+        c->cursor_x = c->cursor_y = -1;
+    const HyprClient *active = hypr_active();
+    c->active_pid = active ? active->pid : -1;
+    snprintf(c->active_title, sizeof(c->active_title), "%s", active ? active->title : "");
+
+    if (st->pins) g_hash_table_destroy(st->pins);
+    st->pins = NULL;
+    if (!st->label_space) st->label_space = g_array_new(FALSE, FALSE, sizeof(LabelSlot));
+    label_space_reset(st->label_space);
+    st->label_missing = 0;
+    gboolean snap = !st->headless && snapshot_load(active, &c->snap);
+    prewalk_trigger(active, snap);
+    if (snap) {
+        fprintf(stderr, "[wlim] showing %d targets from the last walk of \"%s\"\n",
+                c->snap.n, c->active_title);
+        c->snap_live = TRUE;
+        collect_show(c);
+        labels_pin_save(st);
+        c->resume_id = g_timeout_add(SNAPSHOT_PAINT_MS, collect_resume_cb, c);
+        return;
+    }
+    collect_walk(c);
+}
+
+/* the walk proper: list the apps, the focused window first, then the
+ * rest in the background */
+static void collect_walk(Collect *c) {
+    c->desktop = atspi_get_desktop(0);
+    c->napps = atspi_accessible_get_child_count(c->desktop, NULL);
+    if (c->napps < 0) c->napps = 0;
+    c->apps = g_new0(AtspiAccessible *, c->napps);
+    c->res = g_new0(AppResult, c->napps);
+    for (int i = 0; i < c->napps; i++) {
+        c->apps[i] = atspi_accessible_get_child_at_index(c->desktop, i, NULL);
+        if (c->apps[i]) c->res[i].pid = (int)atspi_accessible_get_process_id(c->apps[i], NULL);
+        if (c->res[i].pid > 0 && c->res[i].pid != c->active_pid && slow_skip(c->res[i].pid)) {
+            fprintf(stderr, "[wlim] skipping app %d, over its budget %d times in a row\n",
+                    c->res[i].pid, slow_app(c->res[i].pid)->strikes);
+            c->res[i].pid = 0;
+        }
+        if (c->res[i].pid > 0) c->pending++;
+    }
+
+    /* apps that went over their budget lately go last */
+    c->order = g_new(int, MAX(c->napps, 1));
+    int n = 0;
+    for (int late = 0; late < 2; late++)
+        for (int i = 0; i < c->napps; i++)
+            if ((slow_app(c->res[i].pid) != NULL) == late) c->order[n++] = i;
+
+    gint64 t0 = g_get_monotonic_time();
+    if (collect_focus(c)) {
+        stats_mark(PHASE_FOCUS);
+        fprintf(stderr, "[wlim] focused window walked in %.1f ms\n",
+                (g_get_monotonic_time() - t0) / 1000.0);
+        c->snap_live = FALSE;
+        collect_show(c);
+        snapshot_save(&c->focus);
+    }
+
+    if (c->pending == 0) {
+        collect_finish(c);
+        return;
+    }
+
+    /* the cache needs live node references, so it walks in-process */
+    if (pool_n > 0 && !win_caches) {
+        static gboolean watching;
+        if (!watching) {
+            for (int w = 0; w < pool_n; w++)
+                g_unix_fd_add(pool[w].fd, G_IO_IN | G_IO_HUP | G_IO_ERR, on_pool_msg, NULL);
+            watching = TRUE;
+        }
+        for (int w = 0; w < pool_n && c->running; w++)
+            if (pool[w].job < 0) collect_dispatch(c, w);
+    } else {
+        c->idle_id = g_idle_add(collect_idle_step, c);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/*  headless runs — collection without an overlay                      */
+/* ------------------------------------------------------------------ */
+
+/* run one whole collection, pool and all, to the end */
+static void collect_sync(State *st) {
+    st->headless = TRUE;
+    collect_begin(st);
+    while (coll.running) g_main_context_iteration(NULL, TRUE);
+}
+
+static int cmp_gint64(const void *a, const void *b) {
+    gint64 x = *(const gint64 *)a, y = *(const gint64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* nearest-rank percentile; sorts v */
+static gint64 percentile(gint64 *v, int n, int pct) {
+    qsort(v, n, sizeof(*v), cmp_gint64);
+    int i = (n * pct + 99) / 100 - 1;
+    return v[CLAMP(i, 0, n - 1)];
+}
+
+/* wlim --bench[=runs]: collect, label and filter everything on the
+ * desktop runs times, then print p50/p99 of each as one JSON line in
+ * microseconds. meant for bench/run.sh, which points wlim at the mock
+ * desktop from bench/mock.c, but works against a real one too.
+ * filtering is what typing costs: narrowing by a whole label and
+ * searching for the first few letters of a name. */
+#define BENCH_QUERY 3
+
+static int bench_main(State *st, int runs) {
+    gint64 *t_collect = g_new(gint64, runs);
+    gint64 *t_labels = g_new(gint64, runs);
+    gint64 *t_filter = g_new(gint64, runs);
+    int targets = 0;
+
+    hint_init(NULL);
+    cfg.snapshot_max_age = 0;  /* always measure the walk */
+    stats.on = TRUE;  /* for the walk counters, summed across workers */
+    for (int r = 0; r < runs; r++) {
+        gint64 t0 = g_get_monotonic_time();
+        stats_begin(t0);
+        collect_sync(st);
+        gint64 t1 = g_get_monotonic_time();
+        generate_labels(st->ts.t, st->ts.n, st->nfocus, coll.cursor_x, coll.cursor_y);
+        gint64 t2 = g_get_monotonic_time();
+
+        label_index_build(st);
+        if (st->nlabeled > 0) {
+            const char *lab = st->ts.t[st->by_label[st->nlabeled / 2]].label;
+            for (int k = 1; lab[k - 1]; k++)
+                label_range(st, lab, k, &st->range_lo, &st->range_hi);
+        }
+        const char *name = "";
+        for (int i = st->ts.n / 2; i < st->ts.n && !name[0]; i++) name = ts_name(&st->ts, i);
+        search_index_build(&st->sx, &st->ts);
+        for (int k = 1; k <= BENCH_QUERY && name[k - 1]; k++)
+            search_query(&st->sx, &st->ts, name, k);
+        gint64 t3 = g_get_monotonic_time();
+
+        t_collect[r] = t1 - t0;
+        t_labels[r] = t2 - t1;
+        t_filter[r] = t3 - t2;
+        targets = st->ts.n;
+        overlay_clear(st);
+    }
+
+    /* the counters are the last run's */
+    printf("{\"runs\":%d,\"targets\":%d,\"hypr_calls\":%u,"
+           "\"walk\":{\"api_calls\":%u,\"visited\":%u,\"culled\":%u}",
+           runs, targets, stats.hypr_calls,
+           stats.walk_api_calls, stats.walk_visited, stats.walk_culled);
+    const char *name[] = { "collect", "labels", "filter" };
+    gint64 *v[] = { t_collect, t_labels, t_filter };
+    for (int k = 0; k < 3; k++)
+        printf(",\"%s\":{\"p50\":%lld,\"p99\":%lld}", name[k],
+               (long long)percentile(v[k], runs, 50),
+               (long long)percentile(v[k], runs, 99));
+    printf("}\n");
+    fflush(stdout);
+
+    g_free(t_collect);
+    g_free(t_labels);
+    g_free(t_filter);
+    return targets > 0 ? 0 : 1;
+}
+
+/* wlim --dump: everything the overlay would get, without the overlay.
+ * each target is a JSON line on stdout with its raw bounds, click
+ * point, label, name, role, app pid, window and how the window's
+ * coordinates were corrected, focused window first. */
+static int dump_main(State *st) {
+    hint_init(NULL);
+    st->dump = TRUE;
+    collect_sync(st);
+    return st->ts.n > 0 ? 0 : 1;
+}
+
+/* ------------------------------------------------------------------ */
+/*  daemon mode — warm overlay behind a unix socket                    */
+/* ------------------------------------------------------------------ */
+
+/* without XDG_RUNTIME_DIR the socket lives in a private dir under /tmp,
+ * which has to be ours and closed to everyone else */
+static gboolean daemon_socket_path(char *buf, size_t sz) {
+    const char *xrd = getenv("XDG_RUNTIME_DIR");
+    if (xrd) {
+        snprintf(buf, sz, "%s/wlim.sock", xrd);
+        return TRUE;
+    }
+
+    char dir[64];
+    struct stat sb;
+    snprintf(dir, sizeof(dir), "/tmp/wlim-%d", (int)getuid());
+    if (mkdir(dir, 0700) < 0 && errno != EEXIST) return FALSE;
+    if (lstat(dir, &sb) < 0 || !S_ISDIR(sb.st_mode) ||
+        sb.st_uid != getuid() || (sb.st_mode & 077)) {
+        fprintf(stderr, "[wlim] %s isn't a private directory, not using it\n", dir);
+        return FALSE;
+    }
+    snprintf(buf, sz, "%s/wlim.sock", dir);
+    return TRUE;
+}
+
+static int daemon_connect(void) {
+    char path[256];
+    if (!daemon_socket_path(path, sizeof(path))) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* --trigger: poke a running daemon. the send time goes along so the
+ * daemon can report latency from the keypress, not from accept(). */
+static int trigger_send(void) {
+    int fd = daemon_connect();
+    if (fd < 0) return -1;
+
+    char msg[64];
+    int len = snprintf(msg, sizeof(msg), "hint %lld\n",
+                       (long long)g_get_monotonic_time());
+    ssize_t n = write(fd, msg, len);
+    close(fd);
+    return n == len ? 0 : -1;
+}
+
+/* close the overlay. the window is hidden and the click fires once
+ * it's really gone; one-shot mode quits after that click (or right
+ * away when there's nothing to click), the daemon keeps the window. */
+static void overlay_finish(State *s) {
+    collect_cancel();
+    if (!s->should_click) stats_emit();
+
+    if (!s->should_click && !s->daemon) {
+        g_application_quit(G_APPLICATION(s->app));
+        return;
+    }
+
     if (s->should_click) {
-        usleep(150000);
-        do_click(s->click_x, s->click_y, s->click_button);
+        s->chosen_us = g_get_monotonic_time();
+        stats_mark(PHASE_CHOSEN);
+        click_schedule(s);
+    }
+
+    gtk_widget_set_visible(s->win, FALSE);
+    gtk_widget_set_visible(s->search_box, FALSE);
+    if (s->daemon) overlay_clear(s);
+    s->active = FALSE;
+}
+
+/* collect, label and show hints for one trigger */
+static void daemon_session_start(State *s) {
+    s->typed_len = 0;
+    s->typed[0] = '\0';
+    s->search_mode = FALSE;
+    s->search_len = 0;
+    s->search[0] = '\0';
+    s->should_click = FALSE;
+    collect_begin(s);
+}
+
+/* a client that connects and then says nothing is dropped after this */
+#define TRIGGER_READ_MS 1000
+
+typedef struct {
+    State *s;
+    int    fd;
+    guint  watch, timer;
+} TriggerConn;
+
+static void trigger_conn_free(TriggerConn *t) {
+    if (t->watch) g_source_remove(t->watch);
+    if (t->timer) g_source_remove(t->timer);
+    close(t->fd);
+    g_free(t);
+}
+
+static gboolean on_trigger_timeout(gpointer data) {
+    TriggerConn *t = data;
+    t->timer = 0;
+    trigger_conn_free(t);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean on_trigger_msg(gint fd, GIOCondition cond, gpointer data) {
+    TriggerConn *t = data;
+    State *s = t->s;
+    char buf[64] = {0};
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return G_SOURCE_CONTINUE;
+    t->watch = 0;
+    trigger_conn_free(t);
+
+    if (n <= 0 || strncmp(buf, "hint", 4) != 0 || s->active || coll.running)
+        return G_SOURCE_REMOVE;
+
+    long long sent = 0;
+    sscanf(buf + 4, "%lld", &sent);
+
+    s->trigger_us = sent > 0 ? sent : g_get_monotonic_time();
+    stats_begin(s->trigger_us);
+    daemon_session_start(s);
+    return G_SOURCE_REMOVE;
+}
+
+/* the message is read from the main loop, never waited for */
+static gboolean on_trigger(gint fd, GIOCondition cond, gpointer data) {
+    int c = accept(fd, NULL, NULL);
+    if (c < 0) return G_SOURCE_CONTINUE;
+    fcntl(c, F_SETFD, FD_CLOEXEC);
+    fcntl(c, F_SETFL, fcntl(c, F_GETFL) | O_NONBLOCK);
+
+    TriggerConn *t = g_new0(TriggerConn, 1);
+    t->s = data;
+    t->fd = c;
+    t->watch = g_unix_fd_add(c, G_IO_IN | G_IO_HUP | G_IO_ERR, on_trigger_msg, t);
+    t->timer = g_timeout_add(TRIGGER_READ_MS, on_trigger_timeout, t);
+    return G_SOURCE_CONTINUE;
+}
+
+static int daemon_listen(void) {
+    int probe = daemon_connect();
+    if (probe >= 0) {
+        close(probe);
+        fprintf(stderr, "[wlim] daemon already running\n");
+        return -1;
+    }
+
+    char path[256];
+    if (!daemon_socket_path(path, sizeof(path))) return -1;
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(fd, 4) < 0) {
+        fprintf(stderr, "[wlim] cannot listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
     }
+    fprintf(stderr, "[wlim] daemon listening on %s\n", path);
+    return fd;
+}
+
+static void on_daemon_activate(GtkApplication *app, gpointer data) {
+    State *s = data;
+    s->app = app;
+
+    int fd = daemon_listen();
+    if (fd < 0) return;
+
+    overlay_build(s);
+    g_application_hold(G_APPLICATION(app));
+    g_unix_fd_add(fd, G_IO_IN, on_trigger, s);
+}
+
+static int daemon_main(State *st) {
+    st->daemon = TRUE;
+    stats.daemon = TRUE;
+    cache_init();
+    hypr_subscribe();
+    if (prewalk.fd >= 0)
+        g_unix_fd_add(prewalk.fd, G_IO_IN | G_IO_HUP | G_IO_ERR, on_prewalk, NULL);
+    GtkApplication *app = gtk_application_new("dev.wlim.daemon", G_APPLICATION_DEFAULT_FLAGS);
+    g_signal_connect(app, "activate", G_CALLBACK(on_daemon_activate), st);
+    int rc = g_application_run(G_APPLICATION(app), 0, NULL);
+    g_object_unref(app);
+    return rc;
 }
 
 /* ------------------------------------------------------------------ */
@@ -1164,37 +5908,67 @@ static void on_shutdown(GtkApplication *app, gpointer data) {
 /* ------------------------------------------------------------------ */
 
 int main(int argc, char *argv[]) {
-    cfg_load();
+    gint64 start_us = g_get_monotonic_time();
 
     /* check for flags */
-    gboolean scroll_mode = FALSE;
+    gboolean scroll_mode = FALSE, daemon_mode = FALSE, trigger = FALSE;
+    gboolean label_bench_mode = FALSE, dump_mode = FALSE;
+    int bench_runs = 0;
+    const char *walker = NULL;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--scroll") == 0) scroll_mode = TRUE;
+        else if (strncmp(argv[i], "--walker=", 9) == 0) walker = argv[i] + 9;
+        else if (strcmp(argv[i], "--daemon") == 0) daemon_mode = TRUE;
+        else if (strcmp(argv[i], "--trigger") == 0) trigger = TRUE;
+        else if (strcmp(argv[i], "--label-bench") == 0) label_bench_mode = TRUE;
+        else if (strcmp(argv[i], "--stats") == 0) stats.on = TRUE;
+        else if (strcmp(argv[i], "--dump") == 0) dump_mode = TRUE;
+        else if (strcmp(argv[i], "--bench") == 0) bench_runs = 20;
+        else if (strncmp(argv[i], "--bench=", 8) == 0) bench_runs = MAX(atoi(argv[i] + 8), 1);
+    }
+    stats_begin(start_us);
+
+    /* thin client: hand off to the daemon before doing any real work */
+    if (trigger) {
+        if (trigger_send() == 0) return 0;
+        fprintf(stderr, "[wlim] no daemon running, falling back to one-shot\n");
     }
 
+    cfg_load();
+    if (walker) cfg_set("walker", walker);
+    stats_mark(PHASE_CONFIG);
+
     if (scroll_mode) return scroll_main();
+    if (label_bench_mode) return label_bench();
+
+    /* fork walk workers before AT-SPI or GTK exist in this process.
+     * the daemon's cache walks in-process, so it only needs them when
+     * the cache is off. */
+    if (!daemon_mode || cfg.cache_max_age <= 0)
+        pool_start(cfg.walk_workers);
+    if (daemon_mode) prewalk_start();
+
+    /* create the virtual pointer now so the compositor has picked it
+     * up long before the first click. --dump never clicks but labels
+     * like a real run; benchmarks leave the click history alone too. */
+    if (!bench_runs && !dump_mode) pointer_open();
+    if (!bench_runs) history_open();
 
     /* hint mode */
     init_clickable_lut();
-    atspi_init();
-
-    char *clients_json = hyprctl_request("j/clients");
+    a11y_connect();
+    stats_mark(PHASE_ATSPI);
 
     State st = {0};
-    collect_all_targets(&st, clients_json);
-    free(clients_json);
-
-    if (st.n_targets == 0) {
-        system("notify-send -t 3000 wlim 'no clickable elements found'");
-        return 1;
-    }
-
-    generate_labels(st.targets, st.n_targets);
+    if (bench_runs) return bench_main(&st, bench_runs);
+    if (dump_mode) return dump_main(&st);
+    if (daemon_mode) return daemon_main(&st);
+    st.trigger_us = start_us;
 
     GtkApplication *app = gtk_application_new("dev.wlim.overlay", G_APPLICATION_DEFAULT_FLAGS);
     g_signal_connect(app, "activate", G_CALLBACK(on_activate), &st);
-    g_signal_connect(app, "shutdown", G_CALLBACK(on_shutdown), &st);
     g_application_run(G_APPLICATION(app), 0, NULL);
     g_object_unref(app);
-    return 0;
+    pointer_close();
+    return st.ts.n > 0 ? 0 : 1;
 }